@@ -0,0 +1,399 @@
+#define _GNU_SOURCE
+#include "linked_list.h"
+#include "memory_manager.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common_defs.h"
+#include "gitdata.h"
+
+// Contention benchmark for the list and allocator stack as applications use
+// it: N threads share one legacy Node** list and the allocator, each running
+// a random mix of list_insert, list_search, list_delete and raw
+// mem_alloc/mem_free. Every operation is timed on its own; the allocator's
+// lock counters (MemStats) give the time spent waiting for its mutex, which
+// every one of these operations takes.
+
+#define MAX_THREADS 64
+#define DEFAULT_OPS 100000
+#define DEFAULT_PREFILL 1000
+// Raw blocks each thread keeps live; an alloc with the stash full frees the
+// oldest block first.
+#define STASH 64
+#define MIN_BLOCK 16
+#define MAX_BLOCK 256
+// Keys a thread inserted and has yet to delete.
+#define OWN_KEYS 65536
+
+enum
+{
+    OP_INSERT,
+    OP_SEARCH,
+    OP_DELETE,
+    OP_ALLOC,
+    OP_FREE,
+    OP_KINDS
+};
+
+static const char *op_names[OP_KINDS] = {"insert", "search", "delete", "alloc", "free"};
+
+typedef struct Config
+{
+    int mix[OP_KINDS];  // Percentages, summing to 100
+    int ops;            // Per thread
+    int prefill;
+    int keys;           // Searched and inserted keys are below this
+    int pin;
+} Config;
+
+typedef struct Worker
+{
+    pthread_t id;
+    int index;
+    const Config *config;
+    Node **head;
+    pthread_barrier_t *start;
+    unsigned seed;
+    double *samples[OP_KINDS];
+    size_t counts[OP_KINDS];
+    void *stash[STASH];
+    size_t stash_next;
+    uint16_t *own;  // Ring of keys this thread inserted
+    size_t own_head;
+    size_t own_tail;
+} Worker;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(const char *name, double *samples, size_t n)
+{
+    if (n == 0)
+        return;
+    qsort(samples, n, sizeof(double), compare_double);
+    printf("\t%-6s %9zu ops  p50 %6.0f ns  p99 %7.0f ns  p99.9 %8.0f ns  max %9.0f ns\n", name, n,
+           samples[n / 2] * 1e9, samples[n * 99 / 100] * 1e9, samples[n * 999 / 1000] * 1e9, samples[n - 1] * 1e9);
+}
+
+static int pick_op(Worker *worker)
+{
+    int roll = rand_r(&worker->seed) % 100;
+    for (int kind = 0; kind < OP_KINDS; kind++)
+    {
+        if (roll < worker->config->mix[kind])
+            return kind;
+        roll -= worker->config->mix[kind];
+    }
+    return OP_SEARCH;
+}
+
+// Runs one operation of the given kind. Deletes take the oldest key the
+// thread inserted, so that equal insert and delete shares keep the list at
+// its prefilled length; a free with nothing stashed allocates instead.
+static int run_op(Worker *worker, int kind)
+{
+    const Config *config = worker->config;
+    switch (kind)
+    {
+    case OP_INSERT:
+    {
+        uint16_t key = rand_r(&worker->seed) % config->keys;
+        list_insert(worker->head, key);
+        if (worker->own_tail - worker->own_head < OWN_KEYS)
+            worker->own[worker->own_tail++ % OWN_KEYS] = key;
+        return OP_INSERT;
+    }
+    case OP_DELETE:
+    {
+        uint16_t key = worker->own_tail != worker->own_head
+                           ? worker->own[worker->own_head++ % OWN_KEYS]
+                           : (uint16_t)(rand_r(&worker->seed) % config->keys);
+        list_delete(worker->head, key);
+        return OP_DELETE;
+    }
+    case OP_ALLOC:
+    case OP_FREE:
+    {
+        void **slot = &worker->stash[worker->stash_next];
+        if (*slot)
+        {
+            mem_free(*slot);
+            *slot = NULL;
+            return OP_FREE;
+        }
+        if (kind == OP_FREE)
+        {
+            // Free the most recent block, if any.
+            size_t last = (worker->stash_next + STASH - 1) % STASH;
+            if (worker->stash[last])
+            {
+                mem_free(worker->stash[last]);
+                worker->stash[last] = NULL;
+                worker->stash_next = last;
+                return OP_FREE;
+            }
+        }
+        *slot = mem_alloc(MIN_BLOCK + rand_r(&worker->seed) % (MAX_BLOCK - MIN_BLOCK + 1));
+        worker->stash_next = (worker->stash_next + 1) % STASH;
+        return OP_ALLOC;
+    }
+    default:
+        list_search(worker->head, rand_r(&worker->seed) % config->keys);
+        return OP_SEARCH;
+    }
+}
+
+static void pin_thread(int index)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % (cpus > 0 ? cpus : 1), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *worker = arg;
+    if (worker->config->pin)
+        pin_thread(worker->index);
+    pthread_barrier_wait(worker->start);
+
+    struct timespec before, after;
+    for (int i = 0; i < worker->config->ops; i++)
+    {
+        int kind = pick_op(worker);
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        kind = run_op(worker, kind);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+        worker->samples[kind][worker->counts[kind]++] =
+            (after.tv_sec - before.tv_sec) + (after.tv_nsec - before.tv_nsec) / 1e9;
+    }
+
+    pthread_barrier_wait(worker->start);
+
+    for (int i = 0; i < STASH; i++)
+    {
+        mem_free(worker->stash[i]);
+    }
+    return NULL;
+}
+
+static void run_threads(const Config *config, int threads)
+{
+    printf_yellow("  %d thread%s%s, %d ops each, %d-element list:\n", threads, threads == 1 ? "" : "s",
+                  config->pin ? " pinned" : "", config->ops, config->prefill);
+
+    // Nodes for the prefill and every insert, plus each thread's stash.
+    size_t pool = sizeof(Node) * (config->prefill + (size_t)threads * config->ops) + (size_t)threads * STASH * MAX_BLOCK;
+    Node *head = NULL;
+    list_init(&head, pool);
+    srand(42);
+    for (int i = 0; i < config->prefill; i++)
+    {
+        list_insert(&head, rand() % config->keys);
+    }
+
+    Worker *workers = calloc(threads, sizeof(Worker));
+    my_assert(workers != NULL);
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    for (int t = 0; t < threads; t++)
+    {
+        Worker *worker = &workers[t];
+        worker->index = t;
+        worker->config = config;
+        worker->head = &head;
+        worker->start = &start;
+        worker->seed = t + 1;
+        for (int kind = 0; kind < OP_KINDS; kind++)
+        {
+            worker->samples[kind] = malloc(sizeof(double) * config->ops);
+            my_assert(worker->samples[kind] != NULL);
+        }
+        worker->own = malloc(sizeof(uint16_t) * OWN_KEYS);
+        my_assert(worker->own != NULL);
+        pthread_create(&worker->id, NULL, worker_main, worker);
+    }
+
+    // The lock counters are read around the timed section only.
+    MemStats before, after;
+    mem_get_stats(&before);
+    pthread_barrier_wait(&start);
+    double begin = now_sec();
+    pthread_barrier_wait(&start);
+    double elapsed = now_sec() - begin;
+    mem_get_stats(&after);
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(workers[t].id, NULL);
+    }
+
+    printf("\tthroughput %.3f M ops/s\n", (double)config->ops * threads / elapsed / 1e6);
+    for (int kind = 0; kind < OP_KINDS; kind++)
+    {
+        size_t total = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            total += workers[t].counts[kind];
+        }
+        double *samples = malloc(sizeof(double) * (total ? total : 1));
+        my_assert(samples != NULL);
+        size_t n = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            memcpy(samples + n, workers[t].samples[kind], sizeof(double) * workers[t].counts[kind]);
+            n += workers[t].counts[kind];
+        }
+        print_latency(op_names[kind], samples, n);
+        free(samples);
+    }
+
+    size_t acquisitions = after.lock.acquisitions - before.lock.acquisitions;
+    size_t contended = after.lock.contended - before.lock.contended;
+    double wait = (after.lock.wait_ns - before.lock.wait_ns) / 1e9;
+    printf("\tlock   %zu acquisitions, %.1f%% contended, %.3f ms waiting (%.1f%% of thread time, %.0f ns per wait)\n",
+           acquisitions, acquisitions ? 100.0 * contended / acquisitions : 0.0, wait * 1e3,
+           100.0 * wait / (elapsed * threads), contended ? wait * 1e9 / contended : 0.0);
+    printf("\t       %zu won by spinning, %zu parks\n", after.lock.spun - before.lock.spun,
+           after.lock.parks - before.lock.parks);
+
+    for (int t = 0; t < threads; t++)
+    {
+        for (int kind = 0; kind < OP_KINDS; kind++)
+        {
+            free(workers[t].samples[kind]);
+        }
+        free(workers[t].own);
+    }
+    free(workers);
+    pthread_barrier_destroy(&start);
+    list_cleanup(&head);
+}
+
+static int parse_mix(const char *text, int mix[OP_KINDS])
+{
+    int sum = 0;
+    for (int kind = 0; kind < OP_KINDS; kind++)
+    {
+        char *end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value < 0 || value > 100)
+            return -1;
+        mix[kind] = (int)value;
+        sum += mix[kind];
+        text = end;
+        if (kind < OP_KINDS - 1)
+        {
+            if (*text != ',')
+                return -1;
+            text++;
+        }
+    }
+    return *text == '\0' && sum == 100 ? 0 : -1;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [-t threads,...] [-n ops] [-m insert,search,delete,alloc,free] [-s prefill] [-k keys] [-u]\n", name);
+    printf(" -t  Thread counts to run, default 1,2,4,8\n");
+    printf(" -n  Operations per thread, default %d\n", DEFAULT_OPS);
+    printf(" -m  Operation mix in percent, default 20,50,20,5,5\n");
+    printf(" -s  Elements in the list before the run, default %d\n", DEFAULT_PREFILL);
+    printf(" -k  Key range for inserts and searches, default twice the prefill\n");
+    printf(" -u  Leave threads unpinned; by default thread i runs on CPU i modulo the CPU count\n");
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+
+    Config config = {
+        .mix = {20, 50, 20, 5, 5},
+        .ops = DEFAULT_OPS,
+        .prefill = DEFAULT_PREFILL,
+        .keys = 0,
+        .pin = 1,
+    };
+    int thread_counts[MAX_THREADS] = {1, 2, 4, 8};
+    int runs = 4;
+
+    int option;
+    while ((option = getopt(argc, argv, "t:n:m:s:k:uh")) != -1)
+    {
+        switch (option)
+        {
+        case 't':
+        {
+            runs = 0;
+            for (char *part = strtok(optarg, ","); part && runs < MAX_THREADS; part = strtok(NULL, ","))
+            {
+                int threads = atoi(part);
+                if (threads < 1 || threads > MAX_THREADS)
+                {
+                    printf("Thread counts must be between 1 and %d\n", MAX_THREADS);
+                    return 1;
+                }
+                thread_counts[runs++] = threads;
+            }
+            break;
+        }
+        case 'n':
+            config.ops = atoi(optarg);
+            break;
+        case 'm':
+            if (parse_mix(optarg, config.mix) != 0)
+            {
+                printf("The mix needs five percentages summing to 100\n");
+                return 1;
+            }
+            break;
+        case 's':
+            config.prefill = atoi(optarg);
+            break;
+        case 'k':
+            config.keys = atoi(optarg);
+            break;
+        case 'u':
+            config.pin = 0;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.keys == 0)
+        config.keys = config.prefill > 0 ? 2 * config.prefill : 1;
+    if (runs == 0 || config.ops < 1 || config.prefill < 0 || config.keys < 1 || config.keys > 65536)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf_yellow("Lock: %s\n", sync_lock_kind());
+    printf_yellow("Mix: insert %d%%, search %d%%, delete %d%%, alloc %d%%, free %d%%\n", config.mix[OP_INSERT],
+                  config.mix[OP_SEARCH], config.mix[OP_DELETE], config.mix[OP_ALLOC], config.mix[OP_FREE]);
+    for (int i = 0; i < runs; i++)
+    {
+        run_threads(&config, thread_counts[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,1793 @@
+#include "linked_list.h"
+#include "memory_manager.h"
+#include "unrolled_list.h"
+#include "simd_scan.h"
+#include "concurrent_list.h"
+#include "doubly_linked_list.h"
+#include "sorted_list.h"
+#include "offset_list.h"
+#include "rcu_list.h"
+#include "list_snapshot.h"
+#include "list_parallel.h"
+#include "executor.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "common_defs.h"
+#include "gitdata.h"
+
+// Values stay below this so that searching for MISSING_VALUE scans everything.
+#define VALUE_RANGE 60000
+#define MISSING_VALUE 65000
+
+// Walking from the head on every insert costs O(n^2) in total; beyond this
+// size the naive variant is skipped.
+#define NAIVE_LIMIT 100000
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Reproduces the old list_insert: find the tail by walking, then link.
+static void naive_insert(Node **head, uint16_t data)
+{
+    if (!*head)
+    {
+        list_insert(head, data);
+        return;
+    }
+    Node *current = *head;
+    while (current->next)
+    {
+        current = current->next;
+    }
+    list_insert_after(current, data);
+}
+
+// ********* Append benchmarks *********
+
+void bench_list_build(int count)
+{
+    printf_yellow("  Building a list of %d elements:\n", count);
+
+    List list;
+    mem_init(sizeof(Node) * count);
+    list_create(&list);
+    double start = now_sec();
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i);
+    }
+    double handle_time = now_sec() - start;
+    my_assert(list_length(&list) == (size_t)count);
+    list_destroy(&list);
+    mem_deinit();
+
+    Node *head = NULL;
+    list_init(&head, sizeof(Node) * count);
+    start = now_sec();
+    for (int i = 0; i < count; i++)
+    {
+        list_insert(&head, i);
+    }
+    double legacy_time = now_sec() - start;
+    my_assert(list_count_nodes(&head) == count);
+    list_cleanup(&head);
+
+    printf("\tlist_append:            %10.4f s  (%7.1f ns/op)\n", handle_time, handle_time * 1e9 / count);
+    printf("\tlist_insert (wrapper):  %10.4f s  (%7.1f ns/op)\n", legacy_time, legacy_time * 1e9 / count);
+
+    if (count > NAIVE_LIMIT)
+    {
+        printf("\twalk-to-tail insert:    skipped (O(n^2) above %d)\n", NAIVE_LIMIT);
+        return;
+    }
+
+    head = NULL;
+    list_init(&head, sizeof(Node) * count);
+    start = now_sec();
+    for (int i = 0; i < count; i++)
+    {
+        naive_insert(&head, i);
+    }
+    double naive_time = now_sec() - start;
+    list_cleanup(&head);
+
+    printf("\twalk-to-tail insert:    %10.4f s  (%7.1f ns/op)\n", naive_time, naive_time * 1e9 / count);
+}
+
+void bench_list_count(int count)
+{
+    printf_yellow("  Counting a list of %d elements:\n", count);
+
+    List list;
+    mem_init(sizeof(Node) * count);
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i);
+    }
+
+    double start = now_sec();
+    size_t length = list_length(&list);
+    double handle_time = now_sec() - start;
+
+    start = now_sec();
+    int walked = list_count_nodes(&list.head);
+    double legacy_time = now_sec() - start;
+    my_assert(length == (size_t)walked);
+
+    list_destroy(&list);
+    mem_deinit();
+
+    printf("\tlist_length:            %10.6f s\n", handle_time);
+    printf("\tlist_count_nodes:       %10.6f s\n", legacy_time);
+}
+
+// ********* Unrolled list benchmarks *********
+
+static double bytes_per_element(int count)
+{
+    MemStats stats;
+    mem_get_stats(&stats);
+    return (double)(stats.used_bytes + stats.metadata_bytes) / count;
+}
+
+void bench_ulist_layout(int count)
+{
+    printf_yellow("  Node vs UNode layout, %d elements:\n", count);
+    int rounds = 20;
+
+    List list;
+    mem_init(sizeof(Node) * count);
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i % VALUE_RANGE);
+    }
+    double node_bytes = bytes_per_element(count);
+    double start = now_sec();
+    for (int r = 0; r < rounds; r++)
+    {
+        my_assert(list_find(&list, MISSING_VALUE) == NULL);
+    }
+    double node_time = now_sec() - start;
+    list_destroy(&list);
+    mem_deinit();
+
+    UList ulist;
+    mem_init(sizeof(UNode) * (count / UNODE_CAPACITY + 1));
+    ulist_init(&ulist);
+    for (int i = 0; i < count; i++)
+    {
+        ulist_insert(&ulist, i % VALUE_RANGE);
+    }
+    double unode_bytes = bytes_per_element(count);
+    start = now_sec();
+    for (int r = 0; r < rounds; r++)
+    {
+        my_assert(ulist_search(&ulist, MISSING_VALUE).node == NULL);
+    }
+    double unode_time = now_sec() - start;
+    ulist_cleanup(&ulist);
+    mem_deinit();
+
+    double scanned = (double)count * rounds;
+    printf("\tNode:   %6.2f bytes/element, traversal %8.1f M elements/s\n", node_bytes, scanned / node_time / 1e6);
+    printf("\tUNode:  %6.2f bytes/element, traversal %8.1f M elements/s\n", unode_bytes, scanned / unode_time / 1e6);
+}
+
+// ********* SIMD search benchmarks *********
+
+static const char *simd_names[] = {"scalar", "sse2", "avx2"};
+
+void bench_simd_search(int count)
+{
+    printf_yellow("  Full-length search, %d elements:\n", count);
+    // Scan at least ~50M elements per variant so small sizes are measurable.
+    int rounds = 50000000 / count + 1;
+    double scanned = (double)count * rounds;
+
+    List list;
+    mem_init(sizeof(Node) * count);
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i % VALUE_RANGE);
+    }
+    double start = now_sec();
+    for (int r = 0; r < rounds; r++)
+    {
+        my_assert(list_find(&list, MISSING_VALUE) == NULL);
+    }
+    double node_time = now_sec() - start;
+    list_destroy(&list);
+    mem_deinit();
+    printf("\tNode list_search (scalar): %8.1f M elements/s\n", scanned / node_time / 1e6);
+
+    UList ulist;
+    mem_init(sizeof(UNode) * (count / UNODE_CAPACITY + 1));
+    ulist_init(&ulist);
+    uint16_t *array = malloc(count * sizeof(uint16_t));
+    for (int i = 0; i < count; i++)
+    {
+        ulist_insert(&ulist, i % VALUE_RANGE);
+        array[i] = i % VALUE_RANGE;
+    }
+
+    for (int level = SIMD_SCALAR; level <= (int)simd_detect(); level++)
+    {
+        simd_set_level((SimdLevel)level);
+
+        start = now_sec();
+        for (int r = 0; r < rounds; r++)
+        {
+            my_assert(ulist_search(&ulist, MISSING_VALUE).node == NULL);
+        }
+        double ulist_time = now_sec() - start;
+
+        start = now_sec();
+        for (int r = 0; r < rounds; r++)
+        {
+            my_assert(u16_find(array, count, MISSING_VALUE) < 0);
+        }
+        double array_time = now_sec() - start;
+
+        printf("\t%-6s  UList search: %8.1f M elements/s, array find: %8.1f M elements/s\n",
+               simd_names[level], scanned / ulist_time / 1e6, scanned / array_time / 1e6);
+    }
+    simd_set_level(simd_detect());
+
+    free(array);
+    ulist_cleanup(&ulist);
+    mem_deinit();
+}
+
+// ********* Value index benchmarks *********
+
+static double bench_index_pass(int count, int indexed, int lookups, double *build, double *removal)
+{
+    List list;
+    mem_init(sizeof(Node) * count);
+    if (indexed)
+        list_create_indexed(&list);
+    else
+        list_create(&list);
+
+    double start = now_sec();
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i % VALUE_RANGE);
+    }
+    *build = now_sec() - start;
+
+    srand(42);
+    start = now_sec();
+    for (int i = 0; i < lookups; i++)
+    {
+        uint16_t value = rand() % (count < VALUE_RANGE ? count : VALUE_RANGE);
+        my_assert(list_find(&list, value) != NULL);
+    }
+    double lookup = now_sec() - start;
+
+    srand(43);
+    start = now_sec();
+    for (int i = 0; i < lookups; i++)
+    {
+        list_remove(&list, rand() % VALUE_RANGE);
+    }
+    *removal = now_sec() - start;
+
+    list_destroy(&list);
+    mem_deinit();
+    return lookup;
+}
+
+void bench_list_index(int count)
+{
+    printf_yellow("  Value index, %d elements:\n", count);
+    int lookups = 1000;
+    double plain_build, plain_remove, index_build, index_remove;
+
+    double plain_lookup = bench_index_pass(count, 0, lookups, &plain_build, &plain_remove);
+    double index_lookup = bench_index_pass(count, 1, lookups, &index_build, &index_remove);
+
+    printf("\tappend:  plain %8.1f ns/op, indexed %8.1f ns/op\n",
+           plain_build * 1e9 / count, index_build * 1e9 / count);
+    printf("\tfind:    plain %8.1f ns/op, indexed %8.1f ns/op (%.0fx)\n",
+           plain_lookup * 1e9 / lookups, index_lookup * 1e9 / lookups, plain_lookup / index_lookup);
+    printf("\tremove:  plain %8.1f ns/op, indexed %8.1f ns/op (%.0fx)\n",
+           plain_remove * 1e9 / lookups, index_remove * 1e9 / lookups, plain_remove / index_remove);
+}
+
+// ********* Concurrent list benchmarks *********
+
+#define MIX_PREFILL 1000
+#define MIX_KEYS 2000
+#define MIX_OPS 5000
+
+typedef struct MixArgs
+{
+    List *list;
+    CList *clist;
+    int read_percent;
+    unsigned seed;
+} MixArgs;
+
+// A write deletes a key and, if it was there, puts it back at the front, so
+// the list keeps its size however many threads run.
+static void *mix_worker(void *arg)
+{
+    MixArgs *args = arg;
+    for (int i = 0; i < MIX_OPS; i++)
+    {
+        int roll = rand_r(&args->seed) % 100;
+        uint16_t key = rand_r(&args->seed) % MIX_KEYS;
+        if (args->clist)
+        {
+            if (roll < args->read_percent)
+                clist_contains(args->clist, key);
+            else if (clist_delete(args->clist, key))
+                clist_push_front(args->clist, key);
+        }
+        else
+        {
+            if (roll < args->read_percent)
+                list_find(args->list, key);
+            else if (list_find(args->list, key))
+            {
+                list_remove(args->list, key);
+                list_prepend(args->list, key);
+            }
+        }
+    }
+    return NULL;
+}
+
+static double run_mix(int use_clist, int threads, int read_percent)
+{
+    List list;
+    CList clist;
+    pthread_t ids[threads];
+    MixArgs args[threads];
+
+    mem_init(sizeof(CNode) * MIX_PREFILL * 2);
+    list_create(&list);
+    clist_init(&clist);
+    for (int i = 0; i < MIX_PREFILL; i++)
+    {
+        if (use_clist)
+            clist_push_front(&clist, i * 2);
+        else
+            list_prepend(&list, i * 2);
+    }
+
+    double start = now_sec();
+    for (int t = 0; t < threads; t++)
+    {
+        args[t].list = &list;
+        args[t].clist = use_clist ? &clist : NULL;
+        args[t].read_percent = read_percent;
+        args[t].seed = t + 1;
+        pthread_create(&ids[t], NULL, mix_worker, &args[t]);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    list_destroy(&list);
+    clist_cleanup(&clist);
+    mem_deinit();
+    return (double)MIX_OPS * threads / elapsed / 1e6;
+}
+
+void bench_concurrent_mix(int read_percent)
+{
+    printf_yellow("  %d%% reads, %d-element list, throughput in M ops/s:\n", read_percent, MIX_PREFILL);
+    printf("\tthreads   per-list lock   hand-over-hand\n");
+    for (int threads = 1; threads <= 16; threads *= 2)
+    {
+        double locked = run_mix(0, threads, read_percent);
+        double hoh = run_mix(1, threads, read_percent);
+        printf("\t%7d   %13.3f   %14.3f\n", threads, locked, hoh);
+    }
+}
+
+// ********* RCU list benchmarks *********
+
+#define RCU_READ_PERCENT 95
+
+static void *rcu_worker(void *arg)
+{
+    RList *list = arg;
+    unsigned seed = (unsigned)(uintptr_t)pthread_self();
+    for (int i = 0; i < MIX_OPS; i++)
+    {
+        int roll = rand_r(&seed) % 100;
+        uint16_t key = rand_r(&seed) % MIX_KEYS;
+        if (roll < RCU_READ_PERCENT)
+            rlist_contains(list, key);
+        else if (rlist_delete(list, key))
+            rlist_push_front(list, key);
+    }
+    return NULL;
+}
+
+static double run_rcu(int threads)
+{
+    RList list;
+    pthread_t ids[threads];
+
+    mem_init(sizeof(RNode) * MIX_PREFILL * 2);
+    rlist_init(&list);
+    for (int i = 0; i < MIX_PREFILL; i++)
+    {
+        rlist_push_front(&list, i * 2);
+    }
+
+    double start = now_sec();
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_create(&ids[t], NULL, rcu_worker, &list);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    double elapsed = now_sec() - start;
+
+    rlist_cleanup(&list);
+    mem_deinit();
+    return (double)MIX_OPS * threads / elapsed / 1e6;
+}
+
+void bench_rcu_readers(void)
+{
+    printf_yellow("  %d%% reads, %d-element list, throughput in M ops/s:\n", RCU_READ_PERCENT, MIX_PREFILL);
+    printf("\tthreads   per-list lock        rcu\n");
+    for (int threads = 1; threads <= 32; threads *= 2)
+    {
+        double locked = run_mix(0, threads, RCU_READ_PERCENT);
+        double rcu = run_rcu(threads);
+        printf("\t%7d   %13.3f   %8.3f\n", threads, locked, rcu);
+    }
+}
+
+// ********* Lock overhead benchmarks *********
+
+#define CHURN_BATCH 1000
+#define CHURN_STEPS 200000
+
+// Reproduces the old per-operation path: the list lock, then the allocator
+// lock inside mem_alloc/mem_free.
+typedef struct LockedList
+{
+    Node *head;
+    Node *tail;
+    pthread_mutex_t lock;
+} LockedList;
+
+static void locked_append(LockedList *list, uint16_t data)
+{
+    pthread_mutex_lock(&list->lock);
+    Node *node = mem_alloc(sizeof(Node));
+    if (node)
+    {
+        node->data = data;
+        node->next = NULL;
+        if (list->tail)
+            list->tail->next = node;
+        else
+            list->head = node;
+        list->tail = node;
+    }
+    pthread_mutex_unlock(&list->lock);
+}
+
+static void locked_pop(LockedList *list)
+{
+    pthread_mutex_lock(&list->lock);
+    Node *node = list->head;
+    if (node)
+    {
+        list->head = node->next;
+        if (!list->head)
+            list->tail = NULL;
+        mem_free(node);
+    }
+    pthread_mutex_unlock(&list->lock);
+}
+
+typedef struct ChurnArgs
+{
+    int use_cache;
+} ChurnArgs;
+
+// Each thread owns one list, fills it once and then runs it as a queue:
+// every step appends at the tail and removes the head, so the length stays
+// put and every operation allocates or frees a node.
+static void *churn_worker(void *arg)
+{
+    ChurnArgs *args = arg;
+    if (args->use_cache)
+    {
+        List list;
+        list_create(&list);
+        for (int i = 0; i < CHURN_BATCH; i++)
+            list_append(&list, i);
+        for (int i = 0; i < CHURN_STEPS; i++)
+        {
+            list_append(&list, (CHURN_BATCH + i) % VALUE_RANGE);
+            list_remove(&list, i % VALUE_RANGE);
+        }
+        list_destroy(&list);
+    }
+    else
+    {
+        LockedList list = {NULL, NULL, PTHREAD_MUTEX_INITIALIZER};
+        for (int i = 0; i < CHURN_BATCH; i++)
+            locked_append(&list, i);
+        for (int i = 0; i < CHURN_STEPS; i++)
+        {
+            locked_append(&list, (CHURN_BATCH + i) % VALUE_RANGE);
+            locked_pop(&list);
+        }
+        while (list.head)
+            locked_pop(&list);
+        pthread_mutex_destroy(&list.lock);
+    }
+    return NULL;
+}
+
+static double run_churn(int use_cache, int threads)
+{
+    pthread_t ids[threads];
+    ChurnArgs args = {use_cache};
+
+    mem_init(sizeof(Node) * (CHURN_BATCH + 2 * NODE_CACHE_BATCH) * threads);
+    double start = now_sec();
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_create(&ids[t], NULL, churn_worker, &args);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+    double elapsed = now_sec() - start;
+    mem_deinit();
+    return 2.0 * CHURN_STEPS * threads / elapsed / 1e6;
+}
+
+void bench_list_churn(void)
+{
+    printf_yellow("  Insert/delete churn, one list per thread, throughput in M ops/s:\n");
+    printf("\tthreads   list + allocator lock   list lock + node cache\n");
+    for (int threads = 1; threads <= 8; threads *= 2)
+    {
+        double locked = run_churn(0, threads);
+        double cached = run_churn(1, threads);
+        printf("\t%7d   %21.3f   %22.3f\n", threads, locked, cached);
+    }
+}
+
+// ********* Display benchmarks *********
+
+// Reproduces the old list_display: one or two printf calls per node.
+static void naive_display(FILE *stream, Node *head)
+{
+    fprintf(stream, "[");
+    for (Node *current = head; current; current = current->next)
+    {
+        fprintf(stream, "%d", current->data);
+        if (current->next)
+            fprintf(stream, ", ");
+    }
+    fprintf(stream, "]\n");
+}
+
+void bench_list_display(int count)
+{
+    List list;
+    FILE *sink = fopen("/dev/null", "w");
+    if (!sink)
+    {
+        printf("Failed to open /dev/null\n");
+        return;
+    }
+
+    mem_init(sizeof(Node) * (count + 2 * NODE_CACHE_BATCH));
+    list_create(&list);
+    srand(count);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, rand() % VALUE_RANGE);
+    }
+
+    double start = now_sec();
+    naive_display(sink, list.head);
+    fflush(sink);
+    double naive = now_sec() - start;
+
+    start = now_sec();
+    list_fprint_range(&list, sink, NULL, NULL);
+    fflush(sink);
+    double buffered = now_sec() - start;
+
+    printf_yellow("  Display %d elements to /dev/null:\n", count);
+    printf("\tprintf per node: %.4f s\n", naive);
+    printf("\tbuffered:        %.4f s (%.1fx)\n", buffered, naive / buffered);
+
+    list_destroy(&list);
+    mem_deinit();
+    fclose(sink);
+}
+
+// ********* Positional benchmarks *********
+
+#define POSITIONAL_COUNT 1000000
+// Singly linked insert-before walks from the head, so it gets fewer ops.
+#define POSITIONAL_SINGLY_OPS 200
+#define POSITIONAL_DOUBLY_OPS 1000000
+
+void bench_positional_insert(void)
+{
+    List list;
+    DList dlist;
+    Node **nodes = malloc(sizeof(Node *) * POSITIONAL_COUNT);
+    DNode **dnodes = malloc(sizeof(DNode *) * POSITIONAL_COUNT);
+    if (!nodes || !dnodes)
+    {
+        printf("Failed to allocate node tables\n");
+        free(nodes);
+        free(dnodes);
+        return;
+    }
+
+    mem_init(sizeof(Node) * (POSITIONAL_COUNT + POSITIONAL_SINGLY_OPS + 2 * NODE_CACHE_BATCH));
+    list_create(&list);
+    for (int i = 0; i < POSITIONAL_COUNT; i++)
+    {
+        list_append(&list, i % VALUE_RANGE);
+        nodes[i] = list.tail;
+    }
+    srand(1);
+    double start = now_sec();
+    for (int i = 0; i < POSITIONAL_SINGLY_OPS; i++)
+    {
+        list_add_before(&list, nodes[rand() % POSITIONAL_COUNT], i);
+    }
+    double singly = (now_sec() - start) / POSITIONAL_SINGLY_OPS;
+    list_destroy(&list);
+    mem_deinit();
+
+    mem_init(sizeof(DNode) * (POSITIONAL_COUNT + POSITIONAL_DOUBLY_OPS + 2 * NODE_CACHE_BATCH));
+    dlist_create(&dlist);
+    for (int i = 0; i < POSITIONAL_COUNT; i++)
+    {
+        dnodes[i] = dlist_append(&dlist, i % VALUE_RANGE);
+    }
+    srand(1);
+    start = now_sec();
+    for (int i = 0; i < POSITIONAL_DOUBLY_OPS; i++)
+    {
+        dlist_insert_before(&dlist, dnodes[rand() % POSITIONAL_COUNT], i);
+    }
+    double doubly = (now_sec() - start) / POSITIONAL_DOUBLY_OPS;
+
+    // Delete every original node in random order.
+    for (int i = POSITIONAL_COUNT - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        DNode *swap = dnodes[i];
+        dnodes[i] = dnodes[j];
+        dnodes[j] = swap;
+    }
+    start = now_sec();
+    for (int i = 0; i < POSITIONAL_COUNT; i++)
+    {
+        dlist_delete_node(&dlist, dnodes[i]);
+    }
+    double deletion = (now_sec() - start) / POSITIONAL_COUNT;
+    dlist_destroy(&dlist);
+    mem_deinit();
+
+    printf_yellow("  Random positional operations on a %d-node list, per op:\n", POSITIONAL_COUNT);
+    printf("\tsingly linked insert-before: %10.1f ns\n", singly * 1e9);
+    printf("\tdoubly linked insert-before: %10.1f ns (%.0fx)\n", doubly * 1e9, singly / doubly);
+    printf("\tdoubly linked delete-node:   %10.1f ns\n", deletion * 1e9);
+
+    free(nodes);
+    free(dnodes);
+}
+
+// ********* Sorted list benchmarks *********
+
+#define SORTED_LINEAR_OPS 200
+#define SORTED_SKIP_OPS 100000
+
+// What consumers did before: walk to the first value >= data, then insert
+// before it (which walks again to find the predecessor).
+static void linear_sorted_insert(List *list, uint16_t data)
+{
+    Node *current = list->head;
+    while (current && current->data < data)
+    {
+        current = current->next;
+    }
+    if (current)
+        list_add_before(list, current, data);
+    else
+        list_append(list, data);
+}
+
+void bench_sorted_insert(int count)
+{
+    List list;
+    SList slist;
+
+    mem_init(sizeof(Node) * (count + SORTED_LINEAR_OPS + 2 * NODE_CACHE_BATCH));
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, (uint16_t)((long)i * VALUE_RANGE / count));
+    }
+    srand(count);
+    double start = now_sec();
+    for (int i = 0; i < SORTED_LINEAR_OPS; i++)
+    {
+        linear_sorted_insert(&list, rand() % VALUE_RANGE);
+    }
+    double linear = (now_sec() - start) / SORTED_LINEAR_OPS;
+    list_destroy(&list);
+    mem_deinit();
+
+    // Sized for the worst case; the average node is far smaller.
+    mem_init((sizeof(SNode) + SLIST_MAX_LEVEL * sizeof(SNode *)) * (count + SORTED_SKIP_OPS));
+    slist_create(&slist);
+    for (int i = 0; i < count; i++)
+    {
+        slist_insert(&slist, (uint16_t)((long)i * VALUE_RANGE / count));
+    }
+    srand(count);
+    start = now_sec();
+    for (int i = 0; i < SORTED_SKIP_OPS; i++)
+    {
+        slist_insert(&slist, rand() % VALUE_RANGE);
+    }
+    double skip = (now_sec() - start) / SORTED_SKIP_OPS;
+
+    start = now_sec();
+    for (int i = 0; i < SORTED_SKIP_OPS; i++)
+    {
+        slist_find(&slist, rand() % VALUE_RANGE);
+    }
+    double find = (now_sec() - start) / SORTED_SKIP_OPS;
+    slist_destroy(&slist);
+    mem_deinit();
+
+    printf_yellow("  Sorted insert into %d elements, per op:\n", count);
+    printf("\tlinear scan + insert_before: %10.1f ns\n", linear * 1e9);
+    printf("\tskip list insert:            %10.1f ns (%.0fx)\n", skip * 1e9, linear / skip);
+    printf("\tskip list find:              %10.1f ns\n", find * 1e9);
+}
+
+// ********* Bulk transfer benchmarks *********
+
+void bench_list_bulk(int count)
+{
+    List list;
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+    uint16_t *out = malloc(sizeof(uint16_t) * count);
+    if (!values || !out)
+    {
+        printf("Failed to allocate arrays\n");
+        free(values);
+        free(out);
+        return;
+    }
+    srand(count);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = rand() % VALUE_RANGE;
+    }
+    mem_init(sizeof(Node) * (count + 2 * NODE_CACHE_BATCH));
+
+    double start = now_sec();
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, values[i]);
+    }
+    double looped_load = now_sec() - start;
+
+    start = now_sec();
+    int i = 0;
+    for (Node *current = list.head; current; current = current->next)
+    {
+        out[i++] = current->data;
+    }
+    double looped_export = now_sec() - start;
+    list_destroy(&list);
+
+    start = now_sec();
+    list_from_array(&list, values, count);
+    double bulk_load = now_sec() - start;
+
+    start = now_sec();
+    list_to_array(&list, out, count);
+    double bulk_export = now_sec() - start;
+    if (memcmp(out, values, sizeof(uint16_t) * count) != 0)
+    {
+        printf("Export mismatch\n");
+    }
+    list_destroy(&list);
+    mem_deinit();
+
+    printf_yellow("  Load and export %d values:\n", count);
+    printf("\tlist_append loop:  %.4f s   list_from_array: %.4f s (%.1fx)\n",
+           looped_load, bulk_load, looped_load / bulk_load);
+    printf("\ttraversal loop:    %.4f s   list_to_array:   %.4f s\n", looped_export, bulk_export);
+
+    free(values);
+    free(out);
+}
+
+// ********* Compaction benchmarks *********
+
+#define CHURNED_COUNT 1000000
+#define CHURNED_PASSES 10
+
+// Times CHURNED_PASSES rounds of a full count and a failed search.
+static void time_traversals(List *list, double *count_time, double *search_time)
+{
+    double start = now_sec();
+    for (int i = 0; i < CHURNED_PASSES; i++)
+    {
+        list_count_nodes(&list->head);
+    }
+    *count_time = (now_sec() - start) / CHURNED_PASSES;
+
+    start = now_sec();
+    for (int i = 0; i < CHURNED_PASSES; i++)
+    {
+        list_find(list, MISSING_VALUE);
+    }
+    *search_time = (now_sec() - start) / CHURNED_PASSES;
+}
+
+void bench_list_compact(void)
+{
+    List list;
+    Node **nodes = malloc(sizeof(Node *) * CHURNED_COUNT);
+    if (!nodes)
+    {
+        printf("Failed to allocate node table\n");
+        return;
+    }
+
+    // Room for a second copy, so compaction finds long free extents.
+    mem_init(sizeof(Node) * CHURNED_COUNT * 2);
+    list_create(&list);
+    list_append(&list, 0);
+    nodes[0] = list.head;
+    srand(1);
+    for (int i = 1; i < CHURNED_COUNT; i++)
+    {
+        Node *at = nodes[rand() % i];
+        list_add_after(&list, at, i % VALUE_RANGE);
+        nodes[i] = at->next;
+    }
+
+    double count_before, search_before, count_after, search_after;
+    time_traversals(&list, &count_before, &search_before);
+    double start = now_sec();
+    list_compact(&list);
+    double compact = now_sec() - start;
+    time_traversals(&list, &count_after, &search_after);
+
+    printf_yellow("  Traversing a churned %d-node list:\n", CHURNED_COUNT);
+    printf("\tlist_count_nodes: %.4f s before, %.4f s after (%.1fx)\n",
+           count_before, count_after, count_before / count_after);
+    printf("\tlist_find miss:   %.4f s before, %.4f s after (%.1fx)\n",
+           search_before, search_after, search_before / search_after);
+    printf("\tlist_compact:     %.4f s\n", compact);
+
+    list_destroy(&list);
+    mem_deinit();
+    free(nodes);
+}
+
+// ********* Offset link benchmarks *********
+
+#define LAYOUT_PASSES 10
+
+void bench_olist_layout(int count)
+{
+    List list;
+    OList olist;
+    MemStats stats;
+
+    mem_init(sizeof(Node) * (count + 2 * NODE_CACHE_BATCH));
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i % VALUE_RANGE);
+    }
+    mem_get_stats(&stats);
+    double node_bytes = (double)stats.used_bytes / count;
+    double start = now_sec();
+    for (int i = 0; i < LAYOUT_PASSES; i++)
+    {
+        list_find(&list, MISSING_VALUE);
+    }
+    double node_time = (now_sec() - start) / LAYOUT_PASSES;
+    list_destroy(&list);
+    mem_deinit();
+
+    mem_init(sizeof(ONode) * (count + 2 * NODE_CACHE_BATCH));
+    olist_create(&olist);
+    for (int i = 0; i < count; i++)
+    {
+        olist_append(&olist, i % VALUE_RANGE);
+    }
+    mem_get_stats(&stats);
+    double onode_bytes = (double)stats.used_bytes / count;
+    start = now_sec();
+    for (int i = 0; i < LAYOUT_PASSES; i++)
+    {
+        olist_find(&olist, MISSING_VALUE);
+    }
+    double onode_time = (now_sec() - start) / LAYOUT_PASSES;
+    olist_destroy(&olist);
+    mem_deinit();
+
+    printf_yellow("  %d elements, pool bytes per node and full traversal:\n", count);
+    printf("\tNode  (pointer links): %5.1f B   %.5f s\n", node_bytes, node_time);
+    printf("\tONode (offset links):  %5.1f B   %.5f s (%.2fx)\n", onode_bytes, onode_time, node_time / onode_time);
+}
+
+// ********* Persistence benchmarks *********
+
+#define PERSIST_PATH "/tmp/bench_olist_pool.bin"
+
+void bench_olist_startup(int count)
+{
+    OList list;
+    size_t pool = sizeof(ONode) * (count + 2 * NODE_CACHE_BATCH) + 64;
+    unlink(PERSIST_PATH);
+
+    // Startup without persistence: rebuild element by element.
+    double start = now_sec();
+    mem_init(pool);
+    olist_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        olist_append(&list, i % VALUE_RANGE);
+    }
+    double rebuild = now_sec() - start;
+    olist_destroy(&list);
+    mem_deinit();
+
+    if (mem_init_file(PERSIST_PATH, pool) != 0)
+    {
+        printf("Failed to create %s\n", PERSIST_PATH);
+        return;
+    }
+    olist_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        olist_append(&list, i % VALUE_RANGE);
+    }
+    olist_persist(&list);
+    start = now_sec();
+    mem_deinit();
+    double shutdown = now_sec() - start;
+
+    start = now_sec();
+    mem_init_file(PERSIST_PATH, 0);
+    olist_restore(&list);
+    double reopen = now_sec() - start;
+    start = now_sec();
+    size_t walked = olist_count_nodes(&list);
+    double first_walk = now_sec() - start;
+
+    printf_yellow("  Startup with a %d-element list:\n", count);
+    printf("\trebuild by appending:  %.4f s\n", rebuild);
+    printf("\treopen pool file:      %.4f s (%.1fx), first traversal %.4f s%s\n", reopen,
+           rebuild / reopen, first_walk, walked == (size_t)count ? "" : " (count mismatch)");
+    printf("\tclean shutdown:        %.4f s\n", shutdown);
+
+    olist_destroy(&list);
+    mem_deinit();
+    unlink(PERSIST_PATH);
+}
+
+// ********* Snapshot benchmarks *********
+
+#define SNAPSHOT_PATH "/tmp/bench_list_snapshot.bin"
+
+// Parses the bracketed output of list_write_range back into values.
+static size_t parse_text_list(const char *text, size_t len, uint16_t *out)
+{
+    size_t count = 0;
+    const char *end = text + len;
+    for (const char *p = text; p < end; p++)
+    {
+        if (*p < '0' || *p > '9')
+            continue;
+        unsigned value = 0;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            value = value * 10 + (*p++ - '0');
+        }
+        out[count++] = (uint16_t)value;
+    }
+    return count;
+}
+
+static void snapshot_round_trip(List *list, int count, const char *name, int encoding)
+{
+    List copy;
+    int fd = open(SNAPSHOT_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    double start = now_sec();
+    int saved = encoding < 0 ? list_write_range(list, fd, NULL, NULL) : list_save(list, fd, encoding);
+    double save = now_sec() - start;
+    off_t bytes = lseek(fd, 0, SEEK_END);
+
+    start = now_sec();
+    int loaded;
+    if (encoding < 0)
+    {
+        // Text has no loader of its own: read, parse, then import the array.
+        char *text = malloc(bytes);
+        uint16_t *values = malloc(sizeof(uint16_t) * count);
+        loaded = pread(fd, text, bytes, 0) == bytes &&
+                 parse_text_list(text, bytes, values) == (size_t)count &&
+                 list_from_array(&copy, values, count);
+        free(values);
+        free(text);
+    }
+    else
+    {
+        loaded = list_load(&copy, fd);
+    }
+    double load = now_sec() - start;
+    close(fd);
+
+    printf("\t%-6s %6.1f MB  save %.4f s (%7.1f M values/s)  load %.4f s (%7.1f M values/s)%s\n", name,
+           bytes / 1e6, save, count / save / 1e6, load, count / load / 1e6,
+           saved == 0 && loaded && list_length(&copy) == (size_t)count ? "" : " (failed)");
+    list_destroy(&copy);
+}
+
+void bench_list_snapshot(int count)
+{
+    List list;
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+    mem_init(sizeof(Node) * (2 * count + 4 * NODE_CACHE_BATCH));
+
+    const char *shapes[] = {"random values", "ascending runs"};
+    for (int shape = 0; shape < 2; shape++)
+    {
+        srand(42);
+        for (int i = 0; i < count; i++)
+        {
+            values[i] = shape == 0 ? rand() % VALUE_RANGE : i % VALUE_RANGE;
+        }
+        list_from_array(&list, values, count);
+        printf_yellow("  Save/load round trip, %d elements, %s:\n", count, shapes[shape]);
+        snapshot_round_trip(&list, count, "text", -1);
+        snapshot_round_trip(&list, count, "raw", SNAPSHOT_RAW);
+        snapshot_round_trip(&list, count, "delta", SNAPSHOT_DELTA);
+        list_destroy(&list);
+    }
+
+    mem_deinit();
+    free(values);
+    unlink(SNAPSHOT_PATH);
+}
+
+// ********* Parallel algorithm benchmarks *********
+
+static const int parallel_threads[] = {1, 2, 4, 8};
+
+static uint64_t bench_add(uint64_t a, uint64_t b) { return a + b; }
+static bool bench_keep_low(uint16_t v) { return v < VALUE_RANGE / 2; }
+
+void bench_list_parallel(int count)
+{
+    List list, filtered;
+    static size_t counts[LIST_VALUES];
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+    mem_init(sizeof(Node) * (2 * count + 4 * NODE_CACHE_BATCH));
+    srand(42);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = rand() % VALUE_RANGE;
+    }
+    list_from_array(&list, values, count);
+
+    double start = now_sec();
+    uint64_t serial = 0;
+    for (Node *node = list.head; node; node = node->next)
+    {
+        serial += node->data;
+    }
+    double traversal = now_sec() - start;
+
+    printf_yellow("  Parallel algorithms on %d elements (%ld CPUs online, serial sum %.4f s):\n", count,
+                  sysconf(_SC_NPROCESSORS_ONLN), traversal);
+    // The first filtered copy grows the allocator's tables; keep that out of the timings.
+    list_filter(&list, &filtered, bench_keep_low);
+    list_destroy(&filtered);
+
+    double base[4] = {0};
+    for (size_t t = 0; t < sizeof(parallel_threads) / sizeof(parallel_threads[0]); t++)
+    {
+        list_parallel_set_threads(parallel_threads[t]);
+        double times[4];
+
+        start = now_sec();
+        bool ok = list_reduce(&list, 0, NULL, bench_add) == serial;
+        times[0] = now_sec() - start;
+        start = now_sec();
+        list_histogram(&list, counts);
+        times[1] = now_sec() - start;
+        start = now_sec();
+        ok = list_filter(&list, &filtered, bench_keep_low) && ok;
+        times[2] = now_sec() - start;
+        list_destroy(&filtered);
+        // Sorting an already sorted list costs the same, so every run does the same work.
+        start = now_sec();
+        ok = list_sort(&list) && ok;
+        times[3] = now_sec() - start;
+
+        if (t == 0)
+            memcpy(base, times, sizeof(times));
+        printf("\t%d threads: reduce %.4f s (%.2fx)  histogram %.4f s (%.2fx)  filter %.4f s (%.2fx)  sort %.4f s (%.2fx)%s\n",
+               parallel_threads[t], times[0], base[0] / times[0], times[1], base[1] / times[1], times[2],
+               base[2] / times[2], times[3], base[3] / times[3], ok ? "" : " (failed)");
+    }
+    list_parallel_set_threads(0);
+
+    list_destroy(&list);
+    mem_deinit();
+    free(values);
+}
+
+// ********* Executor benchmarks *********
+
+#define EXECUTOR_BENCH_TASKS 1000000
+#define EXECUTOR_BENCH_DEPTH 19
+
+static const int executor_workers_list[] = {1, 2, 4, 8};
+
+typedef struct SpawnTask
+{
+    Executor *executor;
+    ExecutorGroup *group;
+    int depth;
+} SpawnTask;
+
+static size_t bench_tasks_run;
+
+static void bench_count_task(void *arg)
+{
+    (void)arg;
+    __atomic_add_fetch(&bench_tasks_run, 1, __ATOMIC_RELAXED);
+}
+
+// Binary fan-out: each task spawns two children until depth runs out.
+static void bench_spawn_task(void *arg)
+{
+    SpawnTask *task = arg;
+    __atomic_add_fetch(&bench_tasks_run, 1, __ATOMIC_RELAXED);
+    if (task->depth == 0)
+    {
+        free(task);
+        return;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        SpawnTask *child = malloc(sizeof(SpawnTask));
+        *child = (SpawnTask){task->executor, task->group, task->depth - 1};
+        executor_submit(task->executor, task->group, bench_spawn_task, child);
+    }
+    free(task);
+}
+
+void bench_executor_throughput(int workers)
+{
+    Executor *executor = executor_create(workers, 4096);
+    ExecutorGroup group = EXECUTOR_GROUP_INIT;
+
+    bench_tasks_run = 0;
+    double start = now_sec();
+    for (int i = 0; i < EXECUTOR_BENCH_TASKS; i++)
+    {
+        executor_submit(executor, &group, bench_count_task, NULL);
+    }
+    executor_wait(executor, &group);
+    double external = now_sec() - start;
+
+    size_t spawned = ((size_t)2 << EXECUTOR_BENCH_DEPTH) - 1;
+    bench_tasks_run = 0;
+    SpawnTask *root = malloc(sizeof(SpawnTask));
+    *root = (SpawnTask){executor, &group, EXECUTOR_BENCH_DEPTH};
+    start = now_sec();
+    executor_submit(executor, &group, bench_spawn_task, root);
+    executor_wait(executor, &group);
+    double nested = now_sec() - start;
+
+    printf_yellow("  Executor with %d workers:\n", workers);
+    printf("\tsubmitted from outside: %.2f M tasks/s\n", EXECUTOR_BENCH_TASKS / external / 1e6);
+    printf("\tspawned by tasks:       %.2f M tasks/s%s\n", spawned / nested / 1e6,
+           bench_tasks_run == spawned ? "" : " (count mismatch)");
+    executor_destroy(executor);
+}
+
+static void run_executor_workers(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(executor_workers_list) / sizeof(executor_workers_list[0]); i++)
+    {
+        bench(executor_workers_list[i]);
+    }
+}
+
+// ********* Allocator maintenance benchmarks *********
+
+#define TRACE_SLOTS 50000
+#define TRACE_OPS 100000
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_latency(const char *name, double *samples, size_t n)
+{
+    qsort(samples, n, sizeof(double), compare_double);
+    printf("\t%-6s p50 %6.0f ns  p99 %7.0f ns  p99.9 %8.0f ns  max %9.0f ns\n", name, samples[n / 2] * 1e9,
+           samples[n * 99 / 100] * 1e9, samples[n * 999 / 1000] * 1e9, samples[n - 1] * 1e9);
+}
+
+static size_t trace_size(void)
+{
+    return rand() % 10 == 0 ? 1024 + rand() % 15360 : 16 + rand() % 240;
+}
+
+// Fragments a pool with small holes, then times a random alloc/free trace
+// of mostly small and some medium blocks op by op.
+void bench_alloc_latency(int maintenance)
+{
+    static void *slots[TRACE_SLOTS];
+    static double alloc_ns[TRACE_OPS], free_ns[TRACE_OPS];
+    size_t allocs = 0, frees = 0, failed = 0;
+
+    mem_init(256 << 20);
+    if (maintenance)
+        mem_start_maintenance(1000);
+    srand(42);
+    // Every other small block is freed, leaving holes too small for the
+    // medium requests to come.
+    for (int i = 0; i < TRACE_SLOTS; i++)
+    {
+        slots[i] = mem_alloc(16 + rand() % 112);
+    }
+    for (int i = 0; i < TRACE_SLOTS; i += 2)
+    {
+        mem_free(slots[i]);
+        slots[i] = NULL;
+    }
+
+    for (int op = 0; op < TRACE_OPS; op++)
+    {
+        int slot = rand() % TRACE_SLOTS;
+        double start = now_sec();
+        if (slots[slot])
+        {
+            mem_free(slots[slot]);
+            free_ns[frees++] = now_sec() - start;
+            slots[slot] = NULL;
+        }
+        else
+        {
+            size_t size = trace_size();
+            start = now_sec();
+            slots[slot] = mem_alloc(size);
+            alloc_ns[allocs++] = now_sec() - start;
+            failed += slots[slot] == NULL;
+        }
+    }
+
+    MemStats stats;
+    mem_get_stats(&stats);
+    printf_yellow("  Fragmented alloc/free trace, %s background maintenance (%zu free blocks, %zu failed):\n",
+                  maintenance ? "with" : "without", stats.free_blocks, failed);
+    print_latency("alloc", alloc_ns, allocs);
+    print_latency("free", free_ns, frees);
+
+    for (int i = 0; i < TRACE_SLOTS; i++)
+    {
+        mem_free(slots[i]);
+        slots[i] = NULL;
+    }
+    if (maintenance)
+        mem_stop_maintenance();
+    mem_deinit();
+}
+
+// ********* Remote free benchmarks *********
+
+#define HANDOFF_BLOCKS 2000000
+#define HANDOFF_RING 65536
+
+// Single-producer single-consumer ring carrying blocks from the thread
+// that allocates them to the one that frees them.
+typedef struct Handoff
+{
+    void *ring[HANDOFF_RING];
+    size_t head;
+    size_t tail;
+    int remote;
+    double free_time;
+} Handoff;
+
+static void *handoff_consumer(void *arg)
+{
+    Handoff *handoff = arg;
+    for (size_t taken = 0; taken < HANDOFF_BLOCKS; taken++)
+    {
+        while (__atomic_load_n(&handoff->tail, __ATOMIC_ACQUIRE) == taken)
+            sched_yield();
+        void *block = handoff->ring[taken % HANDOFF_RING];
+        double start = now_sec();
+        if (handoff->remote)
+            mem_free_remote(block);
+        else
+            mem_free(block);
+        handoff->free_time += now_sec() - start;
+        __atomic_store_n(&handoff->head, taken + 1, __ATOMIC_RELEASE);
+    }
+    mem_flush_remote();
+    return NULL;
+}
+
+void bench_remote_free(int remote)
+{
+    static Handoff handoff;
+    memset(&handoff, 0, sizeof(handoff));
+    handoff.remote = remote;
+    mem_init(16 << 20);
+
+    pthread_t consumer;
+    double alloc_time = 0;
+    double start = now_sec();
+    pthread_create(&consumer, NULL, handoff_consumer, &handoff);
+    for (size_t made = 0; made < HANDOFF_BLOCKS; made++)
+    {
+        while (made - __atomic_load_n(&handoff.head, __ATOMIC_ACQUIRE) == HANDOFF_RING)
+            sched_yield();
+        double call = now_sec();
+        void *block = mem_alloc(16);
+        alloc_time += now_sec() - call;
+        handoff.ring[made % HANDOFF_RING] = block;
+        __atomic_store_n(&handoff.tail, made + 1, __ATOMIC_RELEASE);
+    }
+    pthread_join(consumer, NULL);
+    double total = now_sec() - start;
+
+    printf_yellow("  Producer allocates, consumer frees, %s:\n", remote ? "mem_free_remote" : "mem_free");
+    printf("\t%.2f M blocks/s, producer %.0f ns per mem_alloc, consumer %.0f ns per free\n",
+           HANDOFF_BLOCKS / total / 1e6, alloc_time / HANDOFF_BLOCKS * 1e9,
+           handoff.free_time / HANDOFF_BLOCKS * 1e9);
+    mem_deinit();
+}
+
+// ********* Typed allocation benchmarks *********
+
+#define TYPED_PAIRS 2000000
+#define TYPED_MAX_LIVE 1000
+
+typedef struct Obj16
+{
+    char bytes[16];
+} Obj16;
+typedef struct Obj32
+{
+    char bytes[32];
+} Obj32;
+typedef struct Obj64
+{
+    char bytes[64];
+} Obj64;
+
+// Each round allocates live objects and frees them again, once with
+// mem_alloc/mem_free and once through the size-class fast path.
+#define BENCH_TYPED(type)                                                     \
+    static void bench_typed_##type(int live)                                  \
+    {                                                                         \
+        static void *objs[TYPED_MAX_LIVE];                                    \
+        int rounds = TYPED_PAIRS / live;                                      \
+        mem_init(sizeof(type) * TYPED_MAX_LIVE * 2);                          \
+        double start = now_sec();                                             \
+        for (int round = 0; round < rounds; round++)                          \
+        {                                                                     \
+            for (int i = 0; i < live; i++)                                    \
+                objs[i] = mem_alloc(sizeof(type));                            \
+            for (int i = 0; i < live; i++)                                    \
+                mem_free(objs[i]);                                            \
+        }                                                                     \
+        double generic = now_sec() - start;                                   \
+        start = now_sec();                                                    \
+        for (int round = 0; round < rounds; round++)                          \
+        {                                                                     \
+            for (int i = 0; i < live; i++)                                    \
+                objs[i] = MEM_ALLOC_TYPED(type);                              \
+            for (int i = 0; i < live; i++)                                    \
+                MEM_FREE_TYPED(type, objs[i]);                                \
+        }                                                                     \
+        double typed = now_sec() - start;                                     \
+        mem_deinit();                                                         \
+        double pairs = (double)rounds * live;                                 \
+        printf("\t%2zu bytes  %5d   %16.1f   %15.1f   %6.1fx\n", sizeof(type), \
+               live, generic / pairs * 1e9, typed / pairs * 1e9, generic / typed); \
+    }
+
+BENCH_TYPED(Obj16)
+BENCH_TYPED(Obj32)
+BENCH_TYPED(Obj64)
+
+// 32 live objects stay within a thread's class stack; 1000 spill back to
+// the pool in batches.
+void bench_typed_alloc(void)
+{
+    static const int lives[] = {32, TYPED_MAX_LIVE};
+    printf_yellow("  ns per alloc/free pair:\n");
+    printf("\tsize       live   mem_alloc/mem_free   MEM_ALLOC_TYPED   speedup\n");
+    for (int i = 0; i < 2; i++)
+    {
+        bench_typed_Obj16(lives[i]);
+        bench_typed_Obj32(lives[i]);
+        bench_typed_Obj64(lives[i]);
+    }
+}
+
+// ********* Zeroed allocation benchmarks *********
+
+#define CALLOC_SPAN (256u << 20)
+
+// Throughput of zeroed allocations of size bytes in GB/s: fresh pool space
+// with mem_alloc + memset and with mem_calloc, then mem_calloc of space
+// that was just written and freed, and of space released after that.
+void bench_calloc(size_t size)
+{
+    size_t count = CALLOC_SPAN / size;
+    if (count > 256)
+        count = 256;
+    void **blocks = malloc(sizeof(void *) * count);
+    my_assert(blocks != NULL);
+    double times[4] = {0};
+
+    for (int variant = 0; variant < 2; variant++)
+    {
+        mem_init(size * count);
+        double start = now_sec();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (variant == 0)
+            {
+                blocks[i] = mem_alloc(size);
+                memset(blocks[i], 0, size);
+            }
+            else
+            {
+                blocks[i] = mem_calloc(1, size);
+            }
+        }
+        times[variant] = now_sec() - start;
+        mem_deinit();
+    }
+
+    mem_init(size * 2);
+    for (size_t i = 0; i < count; i++)
+    {
+        void *block = mem_alloc(size);
+        memset(block, 0x5a, size);
+        mem_free(block);
+        double start = now_sec();
+        block = mem_calloc(1, size);
+        times[2] += now_sec() - start;
+        mem_free(block);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        void *block = mem_alloc(size);
+        memset(block, 0x5a, size);
+        mem_free(block);
+        mem_release_free_pages();
+        double start = now_sec();
+        block = mem_calloc(1, size);
+        times[3] += now_sec() - start;
+        mem_free(block);
+    }
+    mem_deinit();
+    free(blocks);
+
+    double bytes = (double)size * count;
+    printf("\t%8zu KB   %14.2f   %14.2f   %14.2f   %14.2f\n", size >> 10, bytes / times[0] / 1e9,
+           bytes / times[1] / 1e9, bytes / times[2] / 1e9, bytes / times[3] / 1e9);
+}
+
+static void run_calloc_sizes(void (*bench)(size_t))
+{
+    static const size_t sizes[] = {4u << 10, 64u << 10, 1u << 20, 16u << 20, 64u << 20};
+    printf_yellow("  Zeroed allocation throughput in GB/s:\n");
+    printf("\t    size   alloc+memset   calloc fresh   calloc dirty   calloc released\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        bench(sizes[i]);
+}
+
+// ********* Large block benchmarks *********
+
+#define GROW_FROM (1u << 20)
+#define GROW_TO (128u << 20)
+#define GROW_ROUNDS 5
+
+// Doubles a written buffer from GROW_FROM to GROW_TO with mem_resize,
+// placing a small block right after it each time, as a program allocating
+// between resizes would, so that the pool cannot grow it in place.
+static double grow_buffer(void)
+{
+    double elapsed = 0;
+    size_t size = GROW_FROM;
+    char *buffer = mem_alloc(size);
+    my_assert(buffer != NULL);
+    memset(buffer, 1, size);
+    void *small[16];
+    int smalls = 0;
+    while (size < GROW_TO)
+    {
+        double start = now_sec();
+        buffer = mem_resize(buffer, size * 2);
+        elapsed += now_sec() - start;
+        my_assert(buffer != NULL);
+        memset(buffer + size, 1, size);
+        size *= 2;
+        small[smalls++] = mem_alloc_near(buffer, 64);
+    }
+    mem_free(buffer);
+    for (int i = 0; i < smalls; i++)
+        mem_free(small[i]);
+    return elapsed;
+}
+
+void bench_large_resize(void)
+{
+    printf_yellow("  Growing a buffer from %u MB to %u MB by doubling, total ms in mem_resize:\n",
+                  GROW_FROM >> 20, GROW_TO >> 20);
+    double pooled = 0, mapped = 0;
+    for (int round = 0; round < GROW_ROUNDS; round++)
+    {
+        mem_init(2 * (size_t)GROW_TO + (1 << 20));
+        pooled += grow_buffer();
+        mem_deinit();
+
+        mem_init(1 << 20);
+        mem_set_large_threshold(256 << 10);
+        mapped += grow_buffer();
+        mem_deinit();
+        mem_set_large_threshold(0);
+    }
+    printf("\tpool blocks, memcpy on move   %8.2f ms\n", pooled / GROW_ROUNDS * 1e3);
+    printf("\tlarge blocks, mremap         %8.2f ms\n", mapped / GROW_ROUNDS * 1e3);
+}
+
+static const int list_sizes[] = {10000, 100000, 1000000};
+
+static void run_sizes(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(list_sizes) / sizeof(list_sizes[0]); i++)
+    {
+        bench(list_sizes[i]);
+    }
+}
+
+static const int search_sizes[] = {1000, 10000, 100000, 1000000, 10000000};
+
+static void run_search_sizes(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(search_sizes) / sizeof(search_sizes[0]); i++)
+    {
+        bench(search_sizes[i]);
+    }
+}
+
+static const int sorted_sizes[] = {100000, 1000000};
+
+static void run_sorted_sizes(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(sorted_sizes) / sizeof(sorted_sizes[0]); i++)
+    {
+        bench(sorted_sizes[i]);
+    }
+}
+
+static const int large_sizes[] = {1000000, 10000000};
+
+static void run_large_sizes(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(large_sizes) / sizeof(large_sizes[0]); i++)
+    {
+        bench(large_sizes[i]);
+    }
+}
+
+static const int read_mixes[] = {50, 90, 99};
+
+static void run_read_mixes(void (*bench)(int))
+{
+    for (size_t i = 0; i < sizeof(read_mixes) / sizeof(read_mixes[0]); i++)
+    {
+        bench(read_mixes[i]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+#ifdef VERSION
+    printf("Build Version; %s \n", VERSION);
+#endif
+    printf("Git Version; %s/%s \n", git_date, git_sha);
+
+    if (argc < 2)
+    {
+        printf("Usage: %s <benchmark>\n", argv[0]);
+        printf("Available benchmarks:\n");
+        printf(" 1. bench_list_build - Build lists of 10k, 100k and 1M elements\n");
+        printf(" 2. bench_list_count - Count lists of 10k, 100k and 1M elements\n");
+        printf(" 3. bench_ulist_layout - Memory per element and traversal speed, Node vs UNode\n");
+        printf(" 4. bench_simd_search - Scalar vs SSE2/AVX2 search, 1k to 10M elements\n");
+        printf(" 5. bench_list_index - Find/remove with and without a value index\n");
+        printf(" 6. bench_concurrent_mix - Thread scaling at 50/90/99%% reads, per-list lock vs hand-over-hand\n");
+        printf(" 7. bench_rcu_readers - Thread scaling at 95%% reads, per-list lock vs RCU\n");
+        printf(" 8. bench_list_churn - Insert/delete throughput, double locking vs per-list node cache\n");
+        printf(" 9. bench_list_display - printf per node vs buffered display\n");
+        printf(" 10. bench_positional_insert - Random insert-before on 1M nodes, singly vs doubly linked\n");
+        printf(" 11. bench_sorted_insert - Sorted insert, linear scan vs skip list, 100k and 1M elements\n");
+        printf(" 12. bench_list_bulk - Looped append/traversal vs array import/export\n");
+        printf(" 13. bench_list_compact - Traversal of a churned 1M-node list before and after list_compact\n");
+        printf(" 14. bench_olist_layout - Memory per node and traversal, pointer vs 32-bit offset links\n");
+        printf(" 15. bench_olist_startup - Rebuilding a list vs reopening a persistent pool file\n");
+        printf(" 16. bench_list_snapshot - Text vs binary save/load of 1M and 10M-element lists\n");
+        printf(" 17. bench_list_parallel - Reduce, histogram, filter and sort at 1 to 8 threads, 1M and 10M elements\n");
+        printf(" 18. bench_executor_throughput - Task throughput, external submits and task fan-out, 1 to 8 workers\n");
+        printf(" 19. bench_alloc_latency - Alloc/free latency percentiles on a fragmented pool, with and without maintenance\n");
+        printf(" 20. bench_remote_free - Producer/consumer throughput, mem_free vs mem_free_remote\n");
+        printf(" 21. bench_typed_alloc - mem_alloc vs MEM_ALLOC_TYPED for 16, 32 and 64-byte objects\n");
+        printf(" 22. bench_calloc - Zeroed allocation, mem_alloc + memset vs mem_calloc, 4 KB to 64 MB\n");
+        printf(" 23. bench_large_resize - Growing a large buffer, pool memcpy vs mremap of a large block\n");
+        printf(" 0. Run all benchmarks\n");
+        return 1;
+    }
+
+    switch (atoi(argv[1]))
+    {
+    case 0:
+        run_sizes(bench_list_build);
+        run_sizes(bench_list_count);
+        run_sizes(bench_ulist_layout);
+        run_search_sizes(bench_simd_search);
+        run_sizes(bench_list_index);
+        run_read_mixes(bench_concurrent_mix);
+        bench_rcu_readers();
+        bench_list_churn();
+        run_sizes(bench_list_display);
+        bench_positional_insert();
+        run_sorted_sizes(bench_sorted_insert);
+        run_sizes(bench_list_bulk);
+        bench_list_compact();
+        run_sizes(bench_olist_layout);
+        run_sizes(bench_olist_startup);
+        run_large_sizes(bench_list_snapshot);
+        run_large_sizes(bench_list_parallel);
+        run_executor_workers(bench_executor_throughput);
+        bench_alloc_latency(0);
+        bench_alloc_latency(1);
+        bench_remote_free(0);
+        bench_remote_free(1);
+        bench_typed_alloc();
+        run_calloc_sizes(bench_calloc);
+        bench_large_resize();
+        break;
+    case 1:
+        run_sizes(bench_list_build);
+        break;
+    case 2:
+        run_sizes(bench_list_count);
+        break;
+    case 3:
+        run_sizes(bench_ulist_layout);
+        break;
+    case 4:
+        run_search_sizes(bench_simd_search);
+        break;
+    case 5:
+        run_sizes(bench_list_index);
+        break;
+    case 6:
+        run_read_mixes(bench_concurrent_mix);
+        break;
+    case 7:
+        bench_rcu_readers();
+        break;
+    case 8:
+        bench_list_churn();
+        break;
+    case 9:
+        run_sizes(bench_list_display);
+        break;
+    case 10:
+        bench_positional_insert();
+        break;
+    case 11:
+        run_sorted_sizes(bench_sorted_insert);
+        break;
+    case 12:
+        run_sizes(bench_list_bulk);
+        break;
+    case 13:
+        bench_list_compact();
+        break;
+    case 14:
+        run_sizes(bench_olist_layout);
+        break;
+    case 15:
+        run_sizes(bench_olist_startup);
+        break;
+    case 16:
+        run_large_sizes(bench_list_snapshot);
+        break;
+    case 17:
+        run_large_sizes(bench_list_parallel);
+        break;
+    case 18:
+        run_executor_workers(bench_executor_throughput);
+        break;
+    case 19:
+        bench_alloc_latency(0);
+        bench_alloc_latency(1);
+        break;
+    case 20:
+        bench_remote_free(0);
+        bench_remote_free(1);
+        break;
+    case 21:
+        bench_typed_alloc();
+        break;
+    case 22:
+        run_calloc_sizes(bench_calloc);
+        break;
+    case 23:
+        bench_large_resize();
+        break;
+    default:
+        printf("Invalid benchmark\n");
+        break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "memory_manager.h"
+#include "concurrent_list.h"
+#include <stdio.h>
+
+static CNode * cnode_new(uint16_t data) {
+    CNode * node = (CNode *)mem_alloc(sizeof(CNode));
+    if (!node) return NULL;
+    node->data = data;
+    node->next = NULL;
+    pthread_mutex_init(&node->lock, NULL);
+    return node;
+}
+
+static void cnode_free(CNode * node) {
+    pthread_mutex_destroy(&node->lock);
+    mem_free(node);
+}
+
+void clist_init(CList * list) {
+    list->head.next = NULL;
+    pthread_mutex_init(&list->head.lock, NULL);
+    list->count = 0;
+}
+
+void clist_push_front(CList * list, uint16_t data) {
+    CNode * node = cnode_new(data);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return;
+    }
+
+    pthread_mutex_lock(&list->head.lock);
+    node->next = list->head.next;
+    list->head.next = node;
+    __atomic_add_fetch(&list->count, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&list->head.lock);
+}
+
+void clist_insert(CList * list, uint16_t data) {
+    CNode * node = cnode_new(data);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return;
+    }
+
+    CNode * current = &list->head;
+    pthread_mutex_lock(&current->lock);
+    while (current->next) {
+        CNode * next = current->next;
+        pthread_mutex_lock(&next->lock);
+        pthread_mutex_unlock(&current->lock);
+        current = next;
+    }
+    current->next = node;
+    __atomic_add_fetch(&list->count, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&current->lock);
+}
+
+bool clist_delete(CList * list, uint16_t data) {
+    CNode * previous = &list->head;
+    pthread_mutex_lock(&previous->lock);
+
+    CNode * current = previous->next;
+    while (current) {
+        pthread_mutex_lock(&current->lock);
+        if (current->data == data) {
+            previous->next = current->next;
+            __atomic_sub_fetch(&list->count, 1, __ATOMIC_RELAXED);
+            pthread_mutex_unlock(&current->lock);
+            pthread_mutex_unlock(&previous->lock);
+            // Anyone else reaching current would need previous's lock first.
+            cnode_free(current);
+            return true;
+        }
+        pthread_mutex_unlock(&previous->lock);
+        previous = current;
+        current = current->next;
+    }
+
+    pthread_mutex_unlock(&previous->lock);
+    return false;
+}
+
+bool clist_contains(CList * list, uint16_t data) {
+    CNode * current = &list->head;
+    pthread_mutex_lock(&current->lock);
+
+    while (current->next) {
+        CNode * next = current->next;
+        pthread_mutex_lock(&next->lock);
+        pthread_mutex_unlock(&current->lock);
+        current = next;
+        if (current->data == data) {
+            pthread_mutex_unlock(&current->lock);
+            return true;
+        }
+    }
+
+    pthread_mutex_unlock(&current->lock);
+    return false;
+}
+
+void clist_display(CList * list) {
+    CNode * current = &list->head;
+    pthread_mutex_lock(&current->lock);
+
+    printf("[");
+    while (current->next) {
+        CNode * next = current->next;
+        pthread_mutex_lock(&next->lock);
+        if (current != &list->head) printf(", ");
+        pthread_mutex_unlock(&current->lock);
+        current = next;
+        printf("%d", current->data);
+    }
+    printf("]\n");
+
+    pthread_mutex_unlock(&current->lock);
+}
+
+size_t clist_count_nodes(CList * list) {
+    return __atomic_load_n(&list->count, __ATOMIC_RELAXED);
+}
+
+// Not safe against concurrent use; all other threads must be done.
+void clist_cleanup(CList * list) {
+    CNode * current = list->head.next;
+    while (current) {
+        CNode * next = current->next;
+        cnode_free(current);
+        current = next;
+    }
+    list->head.next = NULL;
+    list->count = 0;
+    pthread_mutex_destroy(&list->head.lock);
+}
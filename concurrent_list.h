@@ -0,0 +1,34 @@
+#ifndef CONCURRENT_LIST_H
+#define CONCURRENT_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Concurrent list with a lock per node. Traversals use hand-over-hand
+// locking (lock the next node before releasing the current one), so several
+// threads can search, insert and delete in different parts of the list at
+// the same time. Node pointers are never handed out, since another thread
+// may free the node as soon as its lock is released.
+typedef struct CNode {
+    uint16_t data;
+    pthread_mutex_t lock;
+    struct CNode * next;
+} CNode;
+
+typedef struct CList {
+    CNode head;  // Sentinel; head.next is the first element
+    size_t count;
+} CList;
+
+void clist_init(CList * list);
+void clist_push_front(CList * list, uint16_t data);
+void clist_insert(CList * list, uint16_t data);
+bool clist_delete(CList * list, uint16_t data);
+bool clist_contains(CList * list, uint16_t data);
+void clist_display(CList * list);
+size_t clist_count_nodes(CList * list);
+void clist_cleanup(CList * list);
+
+#endif // CONCURRENT_LIST_H
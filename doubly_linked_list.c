@@ -0,0 +1,168 @@
+#include "doubly_linked_list.h"
+#include "list_render.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+static DNode * dnode_new(DList * list, uint16_t data, DNode * hint) {
+    DNode * node = node_cache_get(&list->cache, hint);
+    if (!node) return NULL;
+    node->data = data;
+    node->prev = NULL;
+    node->next = NULL;
+    return node;
+}
+
+// Links node in between prev and next, either of which may be NULL.
+static void link_between(DList * list, DNode * node, DNode * prev, DNode * next) {
+    node->prev = prev;
+    node->next = next;
+    if (prev) prev->next = node;
+    else list->head = node;
+    if (next) next->prev = node;
+    else list->tail = node;
+    list->count++;
+}
+
+static void unlink_unlocked(DList * list, DNode * node) {
+    if (node->prev) node->prev->next = node->next;
+    else list->head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else list->tail = node->prev;
+    list->count--;
+    node_cache_put(&list->cache, node);
+}
+
+static DNode * insert_unlocked(DList * list, DNode * prev, DNode * next, uint16_t data) {
+    DNode * node = dnode_new(list, data, prev ? prev : next);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return NULL;
+    }
+    link_between(list, node, prev, next);
+    return node;
+}
+
+static DNode * find_unlocked(DList * list, uint16_t data) {
+    DNode * current = list->head;
+    while (current && current->data != data) {
+        current = current->next;
+    }
+    return current;
+}
+
+void dlist_create(DList * list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    node_cache_init(&list->cache, sizeof(DNode));
+    sync_lock_init(&list->lock);
+}
+
+void dlist_destroy(DList * list) {
+    sync_lock(&list->lock);
+
+    DNode * current = list->head;
+    while (current) {
+        DNode * next = current->next;
+        node_cache_put(&list->cache, current);
+        current = next;
+    }
+    node_cache_drain(&list->cache);
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+
+    sync_unlock(&list->lock);
+    sync_lock_destroy(&list->lock);
+}
+
+DNode * dlist_append(DList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    DNode * node = insert_unlocked(list, list->tail, NULL, data);
+    sync_unlock(&list->lock);
+    return node;
+}
+
+DNode * dlist_prepend(DList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    DNode * node = insert_unlocked(list, NULL, list->head, data);
+    sync_unlock(&list->lock);
+    return node;
+}
+
+DNode * dlist_insert_after(DList * list, DNode * node, uint16_t data) {
+    if (!node) {
+        printf("Cannot insert after a NULL node.\n");
+        return NULL;
+    }
+
+    sync_lock(&list->lock);
+    DNode * new_node = insert_unlocked(list, node, node->next, data);
+    sync_unlock(&list->lock);
+    return new_node;
+}
+
+DNode * dlist_insert_before(DList * list, DNode * node, uint16_t data) {
+    if (!node) {
+        printf("Cannot insert before a NULL node.\n");
+        return NULL;
+    }
+
+    sync_lock(&list->lock);
+    DNode * new_node = insert_unlocked(list, node->prev, node, data);
+    sync_unlock(&list->lock);
+    return new_node;
+}
+
+void dlist_delete_node(DList * list, DNode * node) {
+    if (!node) return;
+
+    sync_lock(&list->lock);
+    unlink_unlocked(list, node);
+    sync_unlock(&list->lock);
+}
+
+int dlist_remove(DList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    DNode * node = find_unlocked(list, data);
+    if (node) unlink_unlocked(list, node);
+    sync_unlock(&list->lock);
+    return node != NULL;
+}
+
+DNode * dlist_find(DList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    DNode * found = find_unlocked(list, data);
+    sync_unlock(&list->lock);
+    return found;
+}
+
+int dlist_fprint_range(DList * list, FILE * stream, DNode * start, DNode * end) {
+    RenderBuf * buf = render_pool_get();
+
+    sync_lock(&list->lock);
+    render_bytes(buf, "[", 1);
+    bool first = true;
+    for (DNode * current = start ? start : list->head; current; current = current->next) {
+        render_item(buf, current->data, first);
+        if (current == end) break;
+        first = false;
+    }
+    render_bytes(buf, "]", 1);
+    sync_unlock(&list->lock);
+
+    return render_emit(buf, stream, -1);
+}
+
+void dlist_print_range(DList * list, DNode * start, DNode * end) {
+    if (dlist_fprint_range(list, stdout, start, end) < 0) {
+        printf("Failed to display list.\n");
+    }
+}
+
+size_t dlist_length(DList * list) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    sync_unlock(&list->lock);
+    return count;
+}
@@ -0,0 +1,45 @@
+#ifndef DOUBLY_LINKED_LIST_H
+#define DOUBLY_LINKED_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "sync_lock.h"
+#include "node_cache.h"
+
+// Doubly linked list. The prev link makes every operation that is given a
+// node O(1): inserting before it, deleting it, and starting a range display
+// at it. Node arguments must belong to the list; they are not searched for.
+// Nodes come from the memory manager pool, which must be initialised
+// (mem_init) before dlist_create is used. Each DList has its own lock.
+typedef struct DNode {
+    uint16_t data;
+    struct DNode * prev;
+    struct DNode * next;
+} DNode;
+
+typedef struct DList {
+    DNode * head;
+    DNode * tail;
+    size_t count;
+    NodeCache cache;
+    SyncLock lock;
+} DList;
+
+void dlist_create(DList * list);
+void dlist_destroy(DList * list);
+// The insert functions return the new node, or NULL if the pool is full.
+DNode * dlist_append(DList * list, uint16_t data);
+DNode * dlist_prepend(DList * list, uint16_t data);
+DNode * dlist_insert_after(DList * list, DNode * node, uint16_t data);
+DNode * dlist_insert_before(DList * list, DNode * node, uint16_t data);
+void dlist_delete_node(DList * list, DNode * node);
+// Removes the first node holding data; returns 1 if one was found.
+int dlist_remove(DList * list, uint16_t data);
+DNode * dlist_find(DList * list, uint16_t data);
+// Prints "[a, b, c]" from start (head if NULL) up to and including end.
+void dlist_print_range(DList * list, DNode * start, DNode * end);
+int dlist_fprint_range(DList * list, FILE * stream, DNode * start, DNode * end);
+size_t dlist_length(DList * list);
+
+#endif // DOUBLY_LINKED_LIST_H
@@ -0,0 +1,283 @@
+#include "executor.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define DEQUE_MIN_CAPACITY 64
+#define SHARED_CAPACITY 4096
+
+typedef struct Job {
+    ExecutorTask task;
+    void* arg;
+    ExecutorGroup* group;
+} Job;
+
+/*
+ * Ring of jobs. The owner pushes and pops at tail; thieves take from head.
+ * Each deque has its own lock, so the owner and a thief only contend when
+ * they meet on the same deque.
+ */
+typedef struct Deque {
+    pthread_mutex_t lock;
+    Job* jobs;
+    size_t mask;  // Capacity - 1; capacities are powers of two
+    size_t head;
+    size_t tail;
+} __attribute__((aligned(64))) Deque;
+
+/*
+ * queued counts jobs that are in a deque or about to be pushed, and is
+ * raised before a push so that it never undercounts. Parking and waking
+ * pair a store to one counter with a load of the other (queued/sleeping,
+ * pending/waiting), all sequentially consistent, so that either the
+ * sleeper sees the new work or the submitter sees the sleeper.
+ */
+struct Executor {
+    int workers;
+    Deque* deques;
+    pthread_t* threads;
+    size_t queued;
+    size_t next_deque;
+    int sleeping;
+    int waiting;
+    bool stop;
+    pthread_mutex_t park_lock;
+    pthread_cond_t park;  // Idle workers
+    pthread_cond_t done;  // Threads in executor_wait
+};
+
+static __thread Executor* current_executor = NULL;
+static __thread int current_worker = -1;
+
+static bool deque_push(Deque* deque, const Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool pushed = deque->tail - deque->head <= deque->mask;
+    if (pushed) deque->jobs[deque->tail++ & deque->mask] = *job;
+    pthread_mutex_unlock(&deque->lock);
+    return pushed;
+}
+
+static bool deque_pop(Deque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool popped = deque->tail != deque->head;
+    if (popped) *job = deque->jobs[--deque->tail & deque->mask];
+    pthread_mutex_unlock(&deque->lock);
+    return popped;
+}
+
+static bool deque_steal(Deque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool stolen = deque->tail != deque->head;
+    if (stolen) *job = deque->jobs[deque->head++ & deque->mask];
+    pthread_mutex_unlock(&deque->lock);
+    return stolen;
+}
+
+// Takes a job from self's own deque (self < 0 has none), else steals one.
+static bool find_job(Executor* executor, int self, Job* job) {
+    if (__atomic_load_n(&executor->queued, __ATOMIC_SEQ_CST) == 0) return false;
+
+    bool found = self >= 0 && deque_pop(&executor->deques[self], job);
+    int start = self >= 0 ? self + 1 : (int)(__atomic_load_n(&executor->next_deque, __ATOMIC_RELAXED) % executor->workers);
+    for (int i = 0; !found && i < executor->workers; i++) {
+        int victim = (start + i) % executor->workers;
+        if (victim != self) found = deque_steal(&executor->deques[victim], job);
+    }
+    if (found) __atomic_sub_fetch(&executor->queued, 1, __ATOMIC_SEQ_CST);
+    return found;
+}
+
+static void group_finish(Executor* executor, ExecutorGroup* group) {
+    if (__atomic_sub_fetch(&group->pending, 1, __ATOMIC_SEQ_CST) != 0) return;
+    if (__atomic_load_n(&executor->waiting, __ATOMIC_SEQ_CST) == 0) return;
+    pthread_mutex_lock(&executor->park_lock);
+    pthread_cond_broadcast(&executor->done);
+    pthread_mutex_unlock(&executor->park_lock);
+}
+
+static void run_job(Executor* executor, const Job* job) {
+    job->task(job->arg);
+    if (job->group) group_finish(executor, job->group);
+}
+
+typedef struct WorkerStart {
+    Executor* executor;
+    int index;
+} WorkerStart;
+
+static void* worker_main(void* arg) {
+    WorkerStart start = *(WorkerStart*)arg;
+    free(arg);
+    Executor* executor = start.executor;
+    current_executor = executor;
+    current_worker = start.index;
+
+    for (;;) {
+        Job job;
+        if (find_job(executor, start.index, &job)) {
+            run_job(executor, &job);
+            continue;
+        }
+
+        pthread_mutex_lock(&executor->park_lock);
+        __atomic_add_fetch(&executor->sleeping, 1, __ATOMIC_SEQ_CST);
+        while (!executor->stop && __atomic_load_n(&executor->queued, __ATOMIC_SEQ_CST) == 0) {
+            pthread_cond_wait(&executor->park, &executor->park_lock);
+        }
+        __atomic_sub_fetch(&executor->sleeping, 1, __ATOMIC_SEQ_CST);
+        bool stop = executor->stop && __atomic_load_n(&executor->queued, __ATOMIC_SEQ_CST) == 0;
+        pthread_mutex_unlock(&executor->park_lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+// Stops and joins the first started workers, then frees the executor.
+static void executor_free(Executor* executor, int started) {
+    pthread_mutex_lock(&executor->park_lock);
+    executor->stop = true;
+    pthread_cond_broadcast(&executor->park);
+    pthread_mutex_unlock(&executor->park_lock);
+    for (int i = 0; i < started; i++) {
+        pthread_join(executor->threads[i], NULL);
+    }
+
+    for (int i = 0; i < executor->workers; i++) {
+        pthread_mutex_destroy(&executor->deques[i].lock);
+        free(executor->deques[i].jobs);
+    }
+    pthread_mutex_destroy(&executor->park_lock);
+    pthread_cond_destroy(&executor->park);
+    pthread_cond_destroy(&executor->done);
+    free(executor->deques);
+    free(executor->threads);
+    free(executor);
+}
+
+Executor* executor_create(int workers, size_t capacity) {
+    if (workers < 1) return NULL;
+    Executor* executor = calloc(1, sizeof(Executor));
+    if (!executor) return NULL;
+    pthread_mutex_init(&executor->park_lock, NULL);
+    pthread_cond_init(&executor->park, NULL);
+    pthread_cond_init(&executor->done, NULL);
+    executor->workers = workers;
+    executor->deques = aligned_alloc(sizeof(Deque), sizeof(Deque) * workers);
+    executor->threads = calloc(workers, sizeof(pthread_t));
+
+    size_t per_worker = DEQUE_MIN_CAPACITY;
+    while (per_worker * workers < capacity) per_worker *= 2;
+    int ready = 0;
+    while (executor->deques && executor->threads && ready < workers) {
+        Deque* deque = &executor->deques[ready];
+        deque->jobs = malloc(sizeof(Job) * per_worker);
+        if (!deque->jobs) break;
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->mask = per_worker - 1;
+        deque->head = 0;
+        deque->tail = 0;
+        ready++;
+    }
+    if (ready < workers) {
+        for (int i = 0; i < ready; i++) {
+            pthread_mutex_destroy(&executor->deques[i].lock);
+            free(executor->deques[i].jobs);
+        }
+        free(executor->deques);
+        free(executor->threads);
+        free(executor);
+        return NULL;
+    }
+
+    for (int i = 0; i < workers; i++) {
+        WorkerStart* start = malloc(sizeof(WorkerStart));
+        if (start) {
+            start->executor = executor;
+            start->index = i;
+        }
+        if (!start || pthread_create(&executor->threads[i], NULL, worker_main, start) != 0) {
+            free(start);
+            executor_free(executor, i);
+            return NULL;
+        }
+    }
+    return executor;
+}
+
+void executor_destroy(Executor* executor) {
+    if (executor) executor_free(executor, executor->workers);
+}
+
+static Executor* shared_executor = NULL;
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+
+static void shared_start(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    shared_executor = executor_create(cpus > 0 ? (int)cpus : 1, SHARED_CAPACITY);
+}
+
+Executor* executor_shared(void) {
+    pthread_once(&shared_once, shared_start);
+    return shared_executor;
+}
+
+int executor_workers(Executor* executor) {
+    return executor->workers;
+}
+
+int executor_try_submit(Executor* executor, ExecutorGroup* group, ExecutorTask task, void* arg) {
+    Job job = { task, arg, group };
+    if (group) __atomic_add_fetch(&group->pending, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&executor->queued, 1, __ATOMIC_SEQ_CST);
+
+    int workers = executor->workers;
+    int first = current_executor == executor
+        ? current_worker
+        : (int)(__atomic_fetch_add(&executor->next_deque, 1, __ATOMIC_RELAXED) % workers);
+    bool pushed = false;
+    for (int i = 0; !pushed && i < workers; i++) {
+        pushed = deque_push(&executor->deques[(first + i) % workers], &job);
+    }
+    if (!pushed) {
+        __atomic_sub_fetch(&executor->queued, 1, __ATOMIC_SEQ_CST);
+        if (group) group_finish(executor, group);
+        return -1;
+    }
+
+    bool sleepers = __atomic_load_n(&executor->sleeping, __ATOMIC_SEQ_CST) > 0;
+    bool waiters = __atomic_load_n(&executor->waiting, __ATOMIC_SEQ_CST) > 0;
+    if (sleepers || waiters) {
+        pthread_mutex_lock(&executor->park_lock);
+        if (sleepers) pthread_cond_signal(&executor->park);
+        if (waiters) pthread_cond_broadcast(&executor->done);
+        pthread_mutex_unlock(&executor->park_lock);
+    }
+    return 0;
+}
+
+void executor_submit(Executor* executor, ExecutorGroup* group, ExecutorTask task, void* arg) {
+    if (executor_try_submit(executor, group, task, arg) != 0) task(arg);
+}
+
+void executor_wait(Executor* executor, ExecutorGroup* group) {
+    int self = current_executor == executor ? current_worker : -1;
+    while (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) > 0) {
+        Job job;
+        if (find_job(executor, self, &job)) {
+            run_job(executor, &job);
+            continue;
+        }
+
+        // Nothing to help with: sleep until the group finishes or new work
+        // is queued.
+        pthread_mutex_lock(&executor->park_lock);
+        __atomic_add_fetch(&executor->waiting, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) > 0
+               && __atomic_load_n(&executor->queued, __ATOMIC_SEQ_CST) == 0) {
+            pthread_cond_wait(&executor->done, &executor->park_lock);
+        }
+        __atomic_sub_fetch(&executor->waiting, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&executor->park_lock);
+    }
+}
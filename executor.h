@@ -0,0 +1,45 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <stddef.h>
+
+/*
+ * Work-stealing executor shared by the allocator and the list algorithms.
+ * Each worker owns a bounded deque: tasks submitted from a worker go to the
+ * back of its own deque and it takes work from the back, while idle
+ * workers steal from the front of the others'. Tasks submitted from other
+ * threads are spread over the deques round robin. Workers that find
+ * nothing to run or steal park until a submit wakes them.
+ */
+typedef struct Executor Executor;
+typedef void (*ExecutorTask)(void* arg);
+
+// Counts a caller's outstanding tasks so that it can wait for them. A group
+// must outlive the tasks submitted with it.
+typedef struct ExecutorGroup {
+    size_t pending;
+} ExecutorGroup;
+
+#define EXECUTOR_GROUP_INIT { 0 }
+
+// Starts workers threads whose deques hold capacity tasks between them.
+// Returns NULL if the executor could not be set up.
+Executor* executor_create(int workers, size_t capacity);
+// Runs whatever is still queued, then stops and joins the workers.
+void executor_destroy(Executor* executor);
+// Process-wide executor with one worker per online CPU, started on first
+// use and never destroyed. NULL if it could not be started.
+Executor* executor_shared(void);
+int executor_workers(Executor* executor);
+
+// Queues task(arg), counted in group unless group is NULL. Returns 0, or -1
+// without queueing anything when every deque is full.
+int executor_try_submit(Executor* executor, ExecutorGroup* group, ExecutorTask task, void* arg);
+// Like executor_try_submit, but when every deque is full the caller runs
+// the task itself, which throttles producers to the workers' pace.
+void executor_submit(Executor* executor, ExecutorGroup* group, ExecutorTask task, void* arg);
+// Returns once every task of group has finished. The caller runs queued
+// tasks while it waits, so waiting from inside a task cannot deadlock.
+void executor_wait(Executor* executor, ExecutorGroup* group);
+
+#endif
@@ -1,224 +1,716 @@
-
 #include "memory_manager.h"
 #include "linked_list.h"
+#include "value_index.h"
+#include "node_cache.h"
+#include "list_render.h"
+#include "list_snapshot.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
-#include <pthread.h>
 
-static pthread_mutex_t list_mutex = PTHREAD_MUTEX_INITIALIZER;
+// The Node ** API has no handle, so the most recently used list is mirrored
+// here to keep list_insert O(1). That API runs entirely under the allocator
+// lock (mem_lock), which also guards this cache, and allocates through the
+// unlocked allocator path. The cached tail may fall behind the real one
+// (list_insert_after on the last node) but is never past it.
+static Node ** cached_ref = NULL;
+static List cached;
+
+static void cache_reset(void) {
+    cached_ref = NULL;
+    cached.head = NULL;
+    cached.tail = NULL;
+    cached.count = 0;
+    cached.index = NULL;
+}
 
-void list_init(Node ** head, size_t pool_size) {
-    pthread_mutex_lock(&list_mutex);
-    mem_init(pool_size);
-    *head = NULL;
-    pthread_mutex_unlock(&list_mutex);
+static List * cache_get(Node ** head) {
+    if (cached_ref != head || cached.head != *head) {
+        cached_ref = head;
+        cached.head = *head;
+        cached.tail = NULL;
+    }
+    if (!cached.tail) cached.tail = cached.head;
+    while (cached.tail && cached.tail->next) {
+        cached.tail = cached.tail->next;
+    }
+    return &cached;
 }
 
-void list_insert(Node ** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+// NULL or the cache means the caller is the Node ** API holding mem_lock.
+static bool is_legacy(List * list) {
+    return !list || list == &cached;
+}
 
-    Node * node = (Node *)mem_alloc(sizeof(Node ));
-    if (!node) {
-        printf("Failed to allocate new node.\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
-    }
+// hint is the node the new one will be linked next to, or NULL.
+static Node * node_new(List * list, uint16_t data, Node * hint) {
+    Node * node = is_legacy(list) ? (Node *)mem_alloc_near_unlocked(hint, sizeof(Node ))
+                                  : (Node *)node_cache_get(&list->cache, hint);
+    if (!node) return NULL;
     node->data = data;
     node->next = NULL;
+    return node;
+}
+
+static void node_release(List * list, Node * node) {
+    if (is_legacy(list)) mem_free_unlocked(node);
+    else node_cache_put(&list->cache, node);
+}
+
+static int append_unlocked(List * list, uint16_t data) {
+    Node * node = node_new(list, data, list->tail);
+    if (!node) return 0;
+    if (list->index && !value_index_add(list->index, node, list->tail)) {
+        node_release(list, node);
+        return 0;
+    }
+
+    if (list->tail) list->tail->next = node;
+    else list->head = node;
+    list->tail = node;
+    list->count++;
+    list->version++;
+    return 1;
+}
+
+static int insert_after_unlocked(List * list, Node * node, uint16_t data) {
+    Node * new_node = node_new(list, data, node);
+    if (!new_node) return 0;
+    if (list && list->index) {
+        if (!value_index_add(list->index, new_node, node)) {
+            node_release(list, new_node);
+            return 0;
+        }
+        if (node->next) value_index_set_prev(list->index, node->next, new_node);
+    }
+
+    new_node->next = node->next;
+    node->next = new_node;
+    if (list && list->tail == node) list->tail = new_node;
+    if (list) {
+        list->count++;
+        list->version++;
+    }
+    return 1;
+}
+
+// Returns 1 on success, 0 on allocation failure and -1 if node is not in list.
+static int insert_before_unlocked(List * list, Node * node, uint16_t data) {
+    Node * new_node = node_new(list, data, node);
+    if (!new_node) return 0;
+
+    if (list->index) {
+        Node * previous = NULL;
+        if (list->head != node && !value_index_get_prev(list->index, node, &previous)) {
+            node_release(list, new_node);
+            return -1;
+        }
+        if (!value_index_add(list->index, new_node, previous)) {
+            node_release(list, new_node);
+            return 0;
+        }
+        value_index_set_prev(list->index, node, new_node);
+
+        new_node->next = node;
+        if (previous) previous->next = new_node;
+        else list->head = new_node;
+        list->count++;
+        list->version++;
+        return 1;
+    }
+
+    if (list->head == node) {
+        new_node->next = list->head;
+        list->head = new_node;
+        list->count++;
+        list->version++;
+        return 1;
+    }
+
+    Node * current = list->head;
+    while (current && current->next != node) {
+        current = current->next;
+    }
+
+    if (!current) {
+        node_release(list, new_node);
+        return -1;
+    }
+
+    new_node->next = node;
+    current->next = new_node;
+    list->count++;
+    list->version++;
+    return 1;
+}
+
+static void delete_unlocked(List * list, uint16_t data) {
+    Node * current = list->head;
+    Node * previous = NULL;
 
-    if (*head == NULL) {
-        *head = node;
+    if (list->index) {
+        current = value_index_first(list->index, data, &previous);
+        if (!current) return;
+        if (current->next) value_index_set_prev(list->index, current->next, previous);
+        value_index_remove(list->index, current);
     } else {
-        Node * current = *head;
-        while (current->next != NULL) {
+        while (current && current->data != data) {
+            previous = current;
             current = current->next;
         }
-        current->next = node;
     }
 
-    pthread_mutex_unlock(&list_mutex);
+    if (!current) return;
+
+    if (previous) previous->next = current->next;
+    else list->head = current->next;
+    if (list->tail == current) list->tail = previous;
+    list->count--;
+    list->version++;
+
+    node_release(list, current);
+}
+
+static Node * search_unlocked(Node * head, uint16_t data) {
+    Node * current = head;
+    while (current) {
+        if (current->data == data) return current;
+        current = current->next;
+    }
+    return NULL;
+}
+
+// Renders "[a, b, c]" from start (head if NULL) up to and including end.
+static void render_range(RenderBuf * buf, Node * head, Node * start, Node * end) {
+    Node * current = head;
+    if (!start) start = head;
+
+    while (current && current != start) {
+        current = current->next;
+    }
+
+    render_bytes(buf, "[", 1);
+    bool first = true;
+    while (current) {
+        render_item(buf, current->data, first);
+        if (current == end) break;
+        first = false;
+        current = current->next;
+    }
+    render_bytes(buf, "]", 1);
+}
+
+static void free_nodes_unlocked(List * list, Node * head) {
+    Node * current = head;
+    while (current) {
+        Node * next = current->next;
+        node_release(list, current);
+        current = next;
+    }
+    if (!is_legacy(list)) node_cache_drain(&list->cache);
+}
+
+// Allocates a private chain holding values under a single allocator lock.
+// Returns its first node and sets *last, or NULL if the pool ran out.
+static Node * chain_new(const uint16_t * values, size_t count, Node ** last) {
+    Node * first = NULL;
+    Node * tail = NULL;
+
+    mem_lock();
+    for (size_t i = 0; i < count; i++) {
+        Node * node = (Node *)mem_alloc_unlocked(sizeof(Node ));
+        if (!node) {
+            free_nodes_unlocked(NULL, first);
+            mem_unlock();
+            return NULL;
+        }
+        node->data = values[i];
+        node->next = NULL;
+        if (tail) tail->next = node;
+        else first = node;
+        tail = node;
+    }
+    mem_unlock();
+
+    *last = tail;
+    return first;
+}
+
+void list_init(Node ** head, size_t pool_size) {
+    mem_init(pool_size);
+    mem_lock();
+    *head = NULL;
+    cache_reset();
+    mem_unlock();
+}
+
+void list_insert(Node ** head, uint16_t data) {
+    mem_lock();
+
+    List * list = cache_get(head);
+    if (!append_unlocked(list, data)) {
+        printf("Failed to allocate new node.\n");
+        mem_unlock();
+        return;
+    }
+    *head = list->head;
+
+    mem_unlock();
 }
 
 void list_insert_after(Node * node, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+    mem_lock();
 
     if (!node) {
         printf("Cannot insert after a NULL node.\n");
-        pthread_mutex_unlock(&list_mutex);
+        mem_unlock();
         return;
     }
 
-    Node * new_node = (Node *)mem_alloc(sizeof(Node ));
-    if (!new_node) {
+    if (!insert_after_unlocked(NULL, node, data)) {
         printf("Allocation failed.\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
     }
 
-    new_node->data = data;
-    new_node->next = node->next;
-    node->next = new_node;
-
-    pthread_mutex_unlock(&list_mutex);
+    mem_unlock();
 }
 
 void list_insert_before(Node ** head, Node * node, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+    mem_lock();
 
     if (!head || !*head || !node) {
         printf("Invalid input.\n");
-        pthread_mutex_unlock(&list_mutex);
+        mem_unlock();
         return;
     }
 
-    Node * new_node = (Node *)mem_alloc(sizeof(Node ));
-    if (!new_node) {
+    List * list = cache_get(head);
+    int result = insert_before_unlocked(list, node, data);
+    if (result == 0) {
         printf("Allocation failed.\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
+    } else if (result < 0) {
+        printf("Target node not found.\n");
     }
-    new_node->data = data;
+    *head = list->head;
+
+    mem_unlock();
+}
 
-    if (*head == node) {
-        new_node->next = *head;
-        *head = new_node;
-        pthread_mutex_unlock(&list_mutex);
+void list_delete(Node ** head, uint16_t data) {
+    mem_lock();
+
+    if (!head || !*head) {
+        mem_unlock();
         return;
     }
 
+    List * list = cache_get(head);
+    delete_unlocked(list, data);
+    *head = list->head;
+
+    mem_unlock();
+}
+
+Node * list_search(Node ** head, uint16_t data) {
+    mem_lock();
+    Node * found = search_unlocked(*head, data);
+    mem_unlock();
+    return found;
+}
+
+void list_display(Node ** head) {
+    RenderBuf * buf = render_pool_get();
+    mem_lock();
+    render_range(buf, *head, NULL, NULL);
+    mem_unlock();
+    render_bytes(buf, "\n", 1);
+    if (render_emit(buf, stdout, -1) < 0) {
+        printf("Failed to display list.\n");
+    }
+}
+
+void list_display_range(Node ** head, Node * start, Node * end) {
+    RenderBuf * buf = render_pool_get();
+    mem_lock();
+    render_range(buf, *head, start, end);
+    mem_unlock();
+    if (render_emit(buf, stdout, -1) < 0) {
+        printf("Failed to display list.\n");
+    }
+}
+
+int list_count_nodes(Node ** head) {
+    mem_lock();
+
+    int count = 0;
     Node * current = *head;
-    while (current && current->next != node) {
+    while (current) {
+        count++;
         current = current->next;
     }
 
-    if (!current) {
-        mem_free(new_node);
-        printf("Target node not found.\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
-    }
+    mem_unlock();
+    return count;
+}
 
-    new_node->next = node;
-    current->next = new_node;
+void list_cleanup(Node ** head) {
+    mem_lock();
+    free_nodes_unlocked(NULL, *head);
+    *head = NULL;
+    cache_reset();
+    mem_unlock();
+    mem_deinit();
+}
 
-    pthread_mutex_unlock(&list_mutex);
+void list_create(List * list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    list->version = 0;
+    list->index = NULL;
+    node_cache_init(&list->cache, sizeof(Node ));
+    sync_lock_init(&list->lock);
 }
 
-void list_delete(Node ** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+void list_create_indexed(List * list) {
+    list_create(list);
+    list->index = value_index_new();
+    if (!list->index) {
+        printf("Failed to allocate value index.\n");
+    }
+}
 
-    if (!head || !*head) {
-        pthread_mutex_unlock(&list_mutex);
-        return;
+void list_destroy(List * list) {
+    sync_lock(&list->lock);
+
+    free_nodes_unlocked(list, list->head);
+    value_index_free(list->index);
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    list->version++;
+    list->index = NULL;
+
+    sync_unlock(&list->lock);
+    sync_lock_destroy(&list->lock);
+}
+
+void list_append(List * list, uint16_t data) {
+    sync_lock(&list->lock);
+    if (!append_unlocked(list, data)) {
+        printf("Failed to allocate new node.\n");
     }
+    sync_unlock(&list->lock);
+}
 
-    Node * current = *head;
-    Node * previous = NULL;
+void list_prepend(List * list, uint16_t data) {
+    sync_lock(&list->lock);
 
-    if (current->data == data) {
-        *head = current->next;
-        mem_free(current);
-        pthread_mutex_unlock(&list_mutex);
+    Node * node = node_new(list, data, list->head);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        sync_unlock(&list->lock);
         return;
     }
+    if (list->index) {
+        if (!value_index_add(list->index, node, NULL)) {
+            printf("Failed to allocate new node.\n");
+            node_release(list, node);
+            sync_unlock(&list->lock);
+            return;
+        }
+        if (list->head) value_index_set_prev(list->index, list->head, node);
+    }
+    node->next = list->head;
+    list->head = node;
+    if (!list->tail) list->tail = node;
+    list->count++;
+    list->version++;
 
-    while (current && current->data != data) {
-        previous = current;
-        current = current->next;
+    sync_unlock(&list->lock);
+}
+
+void list_add_after(List * list, Node * node, uint16_t data) {
+    sync_lock(&list->lock);
+
+    if (!node) {
+        printf("Cannot insert after a NULL node.\n");
+    } else if (!insert_after_unlocked(list, node, data)) {
+        printf("Allocation failed.\n");
     }
 
-    if (!current) {
-        pthread_mutex_unlock(&list_mutex);
+    sync_unlock(&list->lock);
+}
+
+void list_add_before(List * list, Node * node, uint16_t data) {
+    sync_lock(&list->lock);
+
+    if (!list->head || !node) {
+        printf("Invalid input.\n");
+        sync_unlock(&list->lock);
         return;
     }
 
-    previous->next = current->next;
-    mem_free(current);
+    int result = insert_before_unlocked(list, node, data);
+    if (result == 0) {
+        printf("Allocation failed.\n");
+    } else if (result < 0) {
+        printf("Target node not found.\n");
+    }
 
-    pthread_mutex_unlock(&list_mutex);
+    sync_unlock(&list->lock);
 }
 
-Node * list_search(Node ** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+void list_remove(List * list, uint16_t data) {
+    sync_lock(&list->lock);
+    delete_unlocked(list, data);
+    sync_unlock(&list->lock);
+}
 
-    Node * current = *head;
-    while (current) {
-        if (current->data == data) {
-            pthread_mutex_unlock(&list_mutex);
-            return current;
-        }
-        current = current->next;
+Node * list_find(List * list, uint16_t data) {
+    sync_lock(&list->lock);
+    Node * found = list->index ? value_index_first(list->index, data, NULL)
+                               : search_unlocked(list->head, data);
+    sync_unlock(&list->lock);
+    return found;
+}
+
+void list_print(List * list) {
+    RenderBuf * buf = render_pool_get();
+    sync_lock(&list->lock);
+    render_range(buf, list->head, NULL, NULL);
+    sync_unlock(&list->lock);
+    render_bytes(buf, "\n", 1);
+    if (render_emit(buf, stdout, -1) < 0) {
+        printf("Failed to display list.\n");
     }
+}
 
-    pthread_mutex_unlock(&list_mutex);
-    return NULL;
+void list_print_range(List * list, Node * start, Node * end) {
+    if (list_fprint_range(list, stdout, start, end) < 0) {
+        printf("Failed to display list.\n");
+    }
 }
 
-void list_display(Node ** head) {
-    pthread_mutex_lock(&list_mutex);
+size_t list_format_range(List * list, Node * start, Node * end, char * out, size_t size) {
+    RenderBuf buf = {out, 0, size ? size - 1 : 0, true};
+    sync_lock(&list->lock);
+    render_range(&buf, list->head, start, end);
+    sync_unlock(&list->lock);
+    if (size) out[buf.len < buf.cap ? buf.len : buf.cap] = '\0';
+    return buf.len;
+}
 
-    Node * current = *head;
-    printf("[");
-    while (current) {
-        printf("%d", current->data);
-        if (current->next) printf(", ");
-        current = current->next;
-    }
-    printf("]\n");
+int list_fprint_range(List * list, FILE * stream, Node * start, Node * end) {
+    RenderBuf * buf = render_pool_get();
+    sync_lock(&list->lock);
+    render_range(buf, list->head, start, end);
+    sync_unlock(&list->lock);
+    return render_emit(buf, stream, -1);
+}
 
-    pthread_mutex_unlock(&list_mutex);
+int list_write_range(List * list, int fd, Node * start, Node * end) {
+    RenderBuf * buf = render_pool_get();
+    sync_lock(&list->lock);
+    render_range(buf, list->head, start, end);
+    sync_unlock(&list->lock);
+    return render_emit(buf, NULL, fd);
 }
 
-void list_display_range(Node ** head, Node * start, Node * end) {
-    pthread_mutex_lock(&list_mutex);
+size_t list_length(List * list) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    sync_unlock(&list->lock);
+    return count;
+}
 
-    Node * current = *head;
-    if (!start) start = *head;
+int list_append_array(List * list, const uint16_t * values, size_t count) {
+    if (count == 0) return 1;
 
-    while (current && current != start) {
-        current = current->next;
+    Node * last;
+    Node * first = chain_new(values, count, &last);
+    if (!first) {
+        printf("Failed to allocate new node.\n");
+        return 0;
     }
 
-    printf("[");
-    bool first = true;
-    while (current) {
-        if (!first) printf(", ");
-        printf("%d", current->data);
-        if (current == end) break;
-        first = false;
-        current = current->next;
+    sync_lock(&list->lock);
+    if (list->index) {
+        Node * previous = list->tail;
+        for (Node * node = first; node; previous = node, node = node->next) {
+            if (value_index_add(list->index, node, previous)) continue;
+
+            for (Node * added = first; added != node; added = added->next) {
+                value_index_remove(list->index, added);
+            }
+            sync_unlock(&list->lock);
+            mem_lock();
+            free_nodes_unlocked(NULL, first);
+            mem_unlock();
+            printf("Failed to allocate new node.\n");
+            return 0;
+        }
     }
-    printf("]\n");
-
-    pthread_mutex_unlock(&list_mutex);
+    if (list->tail) list->tail->next = first;
+    else list->head = first;
+    list->tail = last;
+    list->count += count;
+    list->version++;
+    sync_unlock(&list->lock);
+    return 1;
 }
 
-int list_count_nodes(Node ** head) {
-    pthread_mutex_lock(&list_mutex);
+int list_from_array(List * list, const uint16_t * values, size_t count) {
+    list_create(list);
+    return list_append_array(list, values, count);
+}
 
-    int count = 0;
-    Node * current = *head;
-    while (current) {
-        count++;
-        current = current->next;
+size_t list_to_array(List * list, uint16_t * out, size_t capacity) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    size_t i = 0;
+    for (Node * current = list->head; current && i < capacity; current = current->next) {
+        out[i++] = current->data;
     }
-
-    pthread_mutex_unlock(&list_mutex);
+    sync_unlock(&list->lock);
     return count;
 }
 
-void list_cleanup(Node ** head) {
-    pthread_mutex_lock(&list_mutex);
+// Nodes relocated per allocator run; each run is one contiguous extent.
+#define COMPACT_RUN 4096
+
+int list_compact(List * list) {
+    sync_lock(&list->lock);
+
+    // Spare nodes only fragment the pool the new runs are carved from.
+    node_cache_drain(&list->cache);
+
+    void * fresh[COMPACT_RUN];
+    void * stale[COMPACT_RUN];
+    Node * last = NULL;  // Last relocated node
+    Node * current = list->head;
+    int result = 1;
+    bool moved = false;
 
-    Node * current = *head;
     while (current) {
-        Node * next = current->next;
-        mem_free(current);
-        current = next;
+        size_t want = 0;
+        for (Node * node = current; node && want < COMPACT_RUN; node = node->next) {
+            want++;
+        }
+        size_t got = mem_alloc_run(last, sizeof(Node ), fresh, want);
+        if (got == 0) {
+            result = 0;
+            break;
+        }
+
+        for (size_t i = 0; i < got; i++) {
+            Node * node = fresh[i];
+            node->data = current->data;
+            node->next = current->next;
+            if (last) last->next = node;
+            else list->head = node;
+            stale[i] = current;
+            last = node;
+            current = current->next;
+        }
+        if (!current) list->tail = last;
+        mem_free_batch(stale, got);
+        list->version++;
+        moved = true;
     }
 
-    *head = NULL;
-    mem_deinit();
+    // Index entries point at the old nodes, so the index is rebuilt; if that
+    // fails the list carries on without one.
+    if (list->index && moved) {
+        value_index_free(list->index);
+        list->index = value_index_new();
+        Node * previous = NULL;
+        for (Node * node = list->head; node && list->index; previous = node, node = node->next) {
+            if (!value_index_add(list->index, node, previous)) {
+                value_index_free(list->index);
+                list->index = NULL;
+            }
+        }
+        if (!list->index) {
+            printf("Failed to rebuild value index.\n");
+            result = 0;
+        }
+    }
+
+    sync_unlock(&list->lock);
+    return result;
+}
+
+int list_save(List * list, int fd, int encoding) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    uint8_t * data = malloc(snapshot_bound(encoding, count) + 1);
+    if (!data) {
+        sync_unlock(&list->lock);
+        return -1;
+    }
+    SnapshotWriter writer;
+    snapshot_writer_init(&writer, data, encoding);
+    for (Node * current = list->head; current; current = current->next) {
+        snapshot_put(&writer, current->data);
+    }
+    sync_unlock(&list->lock);
+
+    int result = snapshot_write(fd, &writer, count);
+    free(data);
+    return result;
+}
+
+int list_load(List * list, int fd) {
+    list_create(list);
+
+    Snapshot snap;
+    if (snapshot_open(&snap, fd) != 0) {
+        printf("Failed to read list snapshot.\n");
+        return 0;
+    }
+    SnapshotReader reader;
+    snapshot_reader_init(&reader, &snap);
+
+    // Nodes are carved in adjacent runs and filled straight from the
+    // mapped payload; a malformed value is only noted so that every node
+    // carved so far stays linked and can be released.
+    size_t count = snap.header.count;
+    void * fresh[COMPACT_RUN];
+    Node * first = NULL;
+    Node * last = NULL;
+    size_t loaded = 0;
+    bool valid = true;
+    while (loaded < count) {
+        size_t want = count - loaded < COMPACT_RUN ? count - loaded : COMPACT_RUN;
+        size_t got = mem_alloc_run(last, sizeof(Node ), fresh, want);
+        if (got == 0) break;
+
+        for (size_t i = 0; i < got; i++) {
+            Node * node = fresh[i];
+            valid = snapshot_get(&reader, &node->data) && valid;
+            node->next = NULL;
+            if (last) last->next = node;
+            else first = node;
+            last = node;
+        }
+        loaded += got;
+    }
+    valid = valid && reader.pos == reader.end;
+    snapshot_close(&snap);
+
+    if (loaded < count || !valid) {
+        mem_lock();
+        free_nodes_unlocked(NULL, first);
+        mem_unlock();
+        printf(loaded < count ? "Failed to allocate new node.\n" : "Failed to read list snapshot.\n");
+        return 0;
+    }
 
-    pthread_mutex_unlock(&list_mutex);
+    sync_lock(&list->lock);
+    list->head = first;
+    list->tail = last;
+    list->count = count;
+    list->version++;
+    sync_unlock(&list->lock);
+    return 1;
 }
@@ -1,9 +1,11 @@
-
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
+#include "sync_lock.h"
+#include "node_cache.h"
 
 
 typedef struct Node  {
@@ -11,6 +13,33 @@ typedef struct Node  {
     struct Node * next;
 } Node ;
 
+struct ValueIndex;
+
+// List handle: tracks both ends and the length so that appending and
+// counting are O(1). Nodes come from the memory manager pool, which must be
+// initialised (mem_init) before list_create is used. Each List has its own
+// lock, so operations on unrelated lists do not contend; list_destroy
+// releases it and the list must be created again before reuse.
+//
+// A list made with list_create_indexed also keeps a per-value index, which
+// makes list_find, list_remove and list_add_before O(1) on average. With an
+// index, find and remove act on the oldest node holding the value; that is
+// the first one in list order unless equal values were inserted out of
+// order. Indexed lists must only be changed through the List functions.
+//
+// So that an operation takes only the list's own lock, nodes come from a
+// per-list NodeCache (see node_cache.h); list_destroy returns them all.
+
+typedef struct List {
+    Node * head;
+    Node * tail;
+    size_t count;
+    size_t version;  // Bumped by every change to the nodes or their values
+    struct ValueIndex * index;
+    NodeCache cache;
+    SyncLock lock;
+} List;
+
 void list_init(Node ** head, size_t pool_size);
 void list_insert(Node ** head, uint16_t data);
 void list_insert_after(Node * node, uint16_t data);
@@ -22,4 +51,54 @@ void list_display_range(Node ** head, Node * start, Node * end);
 int list_count_nodes(Node ** head);
 void list_cleanup(Node ** head);
 
+void list_create(List * list);
+void list_create_indexed(List * list);
+void list_destroy(List * list);
+void list_append(List * list, uint16_t data);
+void list_prepend(List * list, uint16_t data);
+void list_add_after(List * list, Node * node, uint16_t data);
+void list_add_before(List * list, Node * node, uint16_t data);
+void list_remove(List * list, uint16_t data);
+Node * list_find(List * list, uint16_t data);
+void list_print(List * list);
+void list_print_range(List * list, Node * start, Node * end);
+size_t list_length(List * list);
+
+// Bulk transfer. The array functions allocate every node under one
+// allocator lock and link them with one list lock; they add all values or,
+// if the pool runs out, none and return 0 (1 on success). list_from_array
+// also creates the list. list_to_array copies up to capacity values in
+// list order and returns the list length, so a short buffer can be
+// detected and resized.
+int list_from_array(List * list, const uint16_t * values, size_t count);
+int list_append_array(List * list, const uint16_t * values, size_t count);
+size_t list_to_array(List * list, uint16_t * out, size_t capacity);
+
+// Binary snapshots (see list_snapshot.h). list_save encodes the list with
+// SNAPSHOT_RAW or SNAPSHOT_DELTA and writes it with one writev call;
+// 0 on success, -1 on failure. list_load creates the list and fills it from
+// a snapshot, mapping regular files (read from their start) instead of
+// reading them and allocating the nodes in adjacent runs. It returns 1 on
+// success and 0 if the snapshot is malformed or the pool runs out, in
+// which case the list is left empty.
+int list_save(List * list, int fd, int encoding);
+int list_load(List * list, int fd);
+
+// Moves the nodes into contiguous runs of pool memory in list order, so a
+// traversal walks memory sequentially. Node pointers held by the caller are
+// invalidated. Returns 0 if the pool ran out of room, in which case the
+// nodes not yet moved stay where they were, or if an indexed list's index
+// could not be rebuilt, in which case the list continues unindexed.
+int list_compact(List * list);
+
+// The display functions render the whole range into a buffer while the
+// lock is held and write it with a single call after releasing it.
+// list_format_range fills a caller buffer snprintf-style: it writes at most
+// size - 1 characters plus a terminator and returns the full length. The
+// stream and descriptor variants print like list_print_range and return 0,
+// or -1 if the output could not be built or written.
+size_t list_format_range(List * list, Node * start, Node * end, char * out, size_t size);
+int list_fprint_range(List * list, FILE * stream, Node * start, Node * end);
+int list_write_range(List * list, int fd, Node * start, Node * end);
+
 #endif // LINKED_LIST_H
@@ -0,0 +1,365 @@
+#include "list_parallel.h"
+#include "value_index.h"
+#include "executor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PARALLEL_MAX_THREADS 64
+// Fewest values worth handing to another thread.
+#define PARALLEL_GRAIN 16384
+// Times list_map and list_sort start over when the list changes under them.
+#define PARALLEL_ATTEMPTS 4
+
+// ********* Running chunks *********
+
+typedef void (*ParallelTask)(void * arg, size_t id);
+
+typedef struct Slice {
+    ParallelTask task;
+    void * arg;
+    size_t id;
+} Slice;
+
+static int parallel_threads;
+
+static void slice_run(void * arg) {
+    Slice * slice = arg;
+    slice->task(slice->arg, slice->id);
+}
+
+int list_parallel_threads(void) {
+    int threads = __atomic_load_n(&parallel_threads, __ATOMIC_RELAXED);
+    if (threads > 0) return threads;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    return cpus < PARALLEL_MAX_THREADS ? (int)cpus : PARALLEL_MAX_THREADS;
+}
+
+void list_parallel_set_threads(int threads) {
+    if (threads < 0) threads = 0;
+    if (threads > PARALLEL_MAX_THREADS) threads = PARALLEL_MAX_THREADS;
+    __atomic_store_n(&parallel_threads, threads, __ATOMIC_RELAXED);
+}
+
+// Runs task(arg, id) for every id below tasks on the shared executor and
+// returns once all have finished. The caller takes id 0 and then helps
+// with the rest while it waits.
+static void parallel_run(size_t tasks, ParallelTask task, void * arg) {
+    Executor * executor = tasks > 1 ? executor_shared() : NULL;
+    if (!executor) {
+        for (size_t id = 0; id < tasks; id++) {
+            task(arg, id);
+        }
+        return;
+    }
+
+    Slice slices[PARALLEL_MAX_THREADS];
+    ExecutorGroup group = EXECUTOR_GROUP_INIT;
+    for (size_t id = 1; id < tasks; id++) {
+        slices[id] = (Slice){ task, arg, id };
+        executor_submit(executor, &group, slice_run, &slices[id]);
+    }
+    task(arg, 0);
+    executor_wait(executor, &group);
+}
+
+// ********* Chunking *********
+
+typedef struct Chunks {
+    uint16_t * values;
+    size_t count;
+    size_t tasks;
+    size_t size;  // Values per task; the last one may get fewer
+} Chunks;
+
+static void chunks_init(Chunks * chunks, uint16_t * values, size_t count) {
+    size_t threads = (size_t)list_parallel_threads();
+    size_t tasks = (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+    chunks->values = values;
+    chunks->count = count;
+    chunks->tasks = tasks < 1 ? 1 : tasks < threads ? tasks : threads;
+    chunks->size = (count + chunks->tasks - 1) / chunks->tasks;
+}
+
+static size_t chunk_begin(const Chunks * chunks, size_t id) {
+    size_t begin = id * chunks->size;
+    return begin < chunks->count ? begin : chunks->count;
+}
+
+static size_t chunk_end(const Chunks * chunks, size_t id) {
+    return chunk_begin(chunks, id + 1);
+}
+
+// Copies the values in list order, or returns NULL if memory ran out. The
+// caller holds the list lock.
+static uint16_t * copy_values(List * list) {
+    uint16_t * values = malloc(sizeof(uint16_t) * (list->count ? list->count : 1));
+    if (!values) return NULL;
+    size_t i = 0;
+    for (Node * current = list->head; current; current = current->next) {
+        values[i++] = current->data;
+    }
+    return values;
+}
+
+// Index entries are keyed by the old values, so the index is rebuilt; if
+// that fails the list carries on without one.
+static int rebuild_index(List * list) {
+    if (!list->index) return 1;
+    value_index_free(list->index);
+    list->index = value_index_new();
+    Node * previous = NULL;
+    for (Node * node = list->head; node && list->index; previous = node, node = node->next) {
+        if (!value_index_add(list->index, node, previous)) {
+            value_index_free(list->index);
+            list->index = NULL;
+        }
+    }
+    if (list->index) return 1;
+    printf("Failed to rebuild value index.\n");
+    return 0;
+}
+
+// ********* Algorithms *********
+
+typedef struct ReduceJob {
+    Chunks chunks;
+    uint64_t identity;
+    uint64_t (*map)(uint16_t);
+    uint64_t (*combine)(uint64_t, uint64_t);
+    uint64_t partial[PARALLEL_MAX_THREADS];
+} ReduceJob;
+
+static void reduce_task(void * arg, size_t id) {
+    ReduceJob * job = arg;
+    const uint16_t * values = job->chunks.values;
+    uint64_t acc = job->identity;
+    size_t end = chunk_end(&job->chunks, id);
+    for (size_t i = chunk_begin(&job->chunks, id); i < end; i++) {
+        acc = job->combine(acc, job->map ? job->map(values[i]) : values[i]);
+    }
+    job->partial[id] = acc;
+}
+
+uint64_t list_reduce(List * list, uint64_t identity, uint64_t (*map)(uint16_t),
+                     uint64_t (*combine)(uint64_t, uint64_t)) {
+    sync_lock(&list->lock);
+    uint16_t * values = copy_values(list);
+    if (!values) {
+        // Out of memory for the copy: reduce in place instead.
+        uint64_t acc = identity;
+        for (Node * current = list->head; current; current = current->next) {
+            acc = combine(acc, map ? map(current->data) : current->data);
+        }
+        sync_unlock(&list->lock);
+        return acc;
+    }
+    ReduceJob job = { .identity = identity, .map = map, .combine = combine };
+    chunks_init(&job.chunks, values, list->count);
+    sync_unlock(&list->lock);
+
+    parallel_run(job.chunks.tasks, reduce_task, &job);
+    free(values);
+
+    uint64_t acc = identity;
+    for (size_t id = 0; id < job.chunks.tasks; id++) {
+        acc = combine(acc, job.partial[id]);
+    }
+    return acc;
+}
+
+typedef struct HistogramJob {
+    Chunks chunks;
+    size_t * local;  // LIST_VALUES counters per task
+    size_t * counts;
+} HistogramJob;
+
+static void histogram_count(void * arg, size_t id) {
+    HistogramJob * job = arg;
+    const uint16_t * values = job->chunks.values;
+    size_t * local = job->local + id * LIST_VALUES;
+    size_t end = chunk_end(&job->chunks, id);
+    for (size_t i = chunk_begin(&job->chunks, id); i < end; i++) {
+        local[values[i]]++;
+    }
+}
+
+// Each task sums one range of buckets across the per-task counters.
+static void histogram_merge(void * arg, size_t id) {
+    HistogramJob * job = arg;
+    size_t tasks = job->chunks.tasks;
+    size_t begin = LIST_VALUES * id / tasks;
+    size_t end = LIST_VALUES * (id + 1) / tasks;
+    for (size_t value = begin; value < end; value++) {
+        size_t sum = 0;
+        for (size_t t = 0; t < tasks; t++) {
+            sum += job->local[t * LIST_VALUES + value];
+        }
+        job->counts[value] = sum;
+    }
+}
+
+static void histogram_values(uint16_t * values, size_t count, size_t counts[LIST_VALUES]) {
+    HistogramJob job = { .counts = counts };
+    chunks_init(&job.chunks, values, count);
+    if (job.chunks.tasks > 1) job.local = calloc(job.chunks.tasks * LIST_VALUES, sizeof(size_t));
+    if (!job.local) {
+        memset(counts, 0, sizeof(size_t) * LIST_VALUES);
+        for (size_t i = 0; i < count; i++) {
+            counts[values[i]]++;
+        }
+        return;
+    }
+    parallel_run(job.chunks.tasks, histogram_count, &job);
+    parallel_run(job.chunks.tasks, histogram_merge, &job);
+    free(job.local);
+}
+
+void list_histogram(List * list, size_t counts[LIST_VALUES]) {
+    sync_lock(&list->lock);
+    uint16_t * values = copy_values(list);
+    if (!values) {
+        memset(counts, 0, sizeof(size_t) * LIST_VALUES);
+        for (Node * current = list->head; current; current = current->next) {
+            counts[current->data]++;
+        }
+        sync_unlock(&list->lock);
+        return;
+    }
+    size_t count = list->count;
+    sync_unlock(&list->lock);
+
+    histogram_values(values, count, counts);
+    free(values);
+}
+
+typedef struct FilterJob {
+    Chunks chunks;
+    bool (*keep)(uint16_t);
+    size_t kept[PARALLEL_MAX_THREADS];
+} FilterJob;
+
+// Packs the accepted values to the front of the task's own chunk.
+static void filter_task(void * arg, size_t id) {
+    FilterJob * job = arg;
+    uint16_t * values = job->chunks.values;
+    size_t begin = chunk_begin(&job->chunks, id);
+    size_t end = chunk_end(&job->chunks, id);
+    size_t out = begin;
+    for (size_t i = begin; i < end; i++) {
+        if (job->keep(values[i])) values[out++] = values[i];
+    }
+    job->kept[id] = out - begin;
+}
+
+int list_filter(List * list, List * out, bool (*keep)(uint16_t)) {
+    sync_lock(&list->lock);
+    uint16_t * values = copy_values(list);
+    FilterJob job = { .keep = keep };
+    chunks_init(&job.chunks, values, list->count);
+    sync_unlock(&list->lock);
+    if (!values) {
+        list_create(out);
+        return 0;
+    }
+
+    parallel_run(job.chunks.tasks, filter_task, &job);
+    size_t total = 0;
+    for (size_t id = 0; id < job.chunks.tasks; id++) {
+        memmove(values + total, values + chunk_begin(&job.chunks, id), sizeof(uint16_t) * job.kept[id]);
+        total += job.kept[id];
+    }
+
+    int result = list_from_array(out, values, total);
+    free(values);
+    return result;
+}
+
+typedef struct MapJob {
+    Chunks chunks;
+    uint16_t (*fn)(uint16_t);
+} MapJob;
+
+static void map_task(void * arg, size_t id) {
+    MapJob * job = arg;
+    uint16_t * values = job->chunks.values;
+    size_t end = chunk_end(&job->chunks, id);
+    for (size_t i = chunk_begin(&job->chunks, id); i < end; i++) {
+        values[i] = job->fn(values[i]);
+    }
+}
+
+/*
+ * list_map and list_sort copy the values and work on them unlocked, then
+ * write the results back only if the list's version is still the one they
+ * copied. Otherwise they start over from a fresh copy, never running a
+ * callback under the list lock, and give up after PARALLEL_ATTEMPTS.
+ */
+int list_map(List * list, uint16_t (*fn)(uint16_t)) {
+    for (int attempt = 0; attempt < PARALLEL_ATTEMPTS; attempt++) {
+        sync_lock(&list->lock);
+        uint16_t * values = copy_values(list);
+        size_t version = list->version;
+        MapJob job = { .fn = fn };
+        chunks_init(&job.chunks, values, list->count);
+        sync_unlock(&list->lock);
+        if (!values) return 0;
+
+        parallel_run(job.chunks.tasks, map_task, &job);
+
+        sync_lock(&list->lock);
+        if (list->version != version) {
+            sync_unlock(&list->lock);
+            free(values);
+            continue;
+        }
+        size_t i = 0;
+        for (Node * current = list->head; current; current = current->next) {
+            current->data = values[i++];
+        }
+        list->version++;
+        free(values);
+        int result = rebuild_index(list);
+        sync_unlock(&list->lock);
+        return result;
+    }
+    return 0;
+}
+
+int list_sort(List * list) {
+    size_t * counts = malloc(sizeof(size_t) * LIST_VALUES);
+    if (!counts) return 0;
+    for (int attempt = 0; attempt < PARALLEL_ATTEMPTS; attempt++) {
+        sync_lock(&list->lock);
+        uint16_t * values = copy_values(list);
+        size_t count = list->count;
+        size_t version = list->version;
+        sync_unlock(&list->lock);
+        if (!values) break;
+
+        histogram_values(values, count, counts);
+        free(values);
+
+        sync_lock(&list->lock);
+        if (list->version != version) {
+            sync_unlock(&list->lock);
+            continue;
+        }
+        Node * current = list->head;
+        for (size_t value = 0; value < LIST_VALUES; value++) {
+            for (size_t n = counts[value]; n > 0; n--) {
+                current->data = (uint16_t)value;
+                current = current->next;
+            }
+        }
+        list->version++;
+        free(counts);
+        int result = rebuild_index(list);
+        sync_unlock(&list->lock);
+        return result;
+    }
+    free(counts);
+    return 0;
+}
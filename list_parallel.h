@@ -0,0 +1,49 @@
+#ifndef LIST_PARALLEL_H
+#define LIST_PARALLEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "linked_list.h"
+
+// Number of distinct node values, and so of list_histogram buckets.
+#define LIST_VALUES 65536
+
+// Parallel algorithms over a List. Each copies the values into an array
+// with one traversal under the list lock and splits the array into chunks
+// that run on the shared executor (executor.h), the caller taking one and
+// helping with the rest; lists shorter than a couple of chunks are handled
+// by the caller alone. The lock is released once the values are copied and
+// callbacks never run under it, so they and other executor tasks may use
+// the list. list_map and list_sort take it again to write the results back
+// and, if the list was changed in between, start over from a new copy.
+
+// Sets how many threads, the caller included, an algorithm spreads its
+// chunks over; 0 (the default) means one per online CPU.
+void list_parallel_set_threads(int threads);
+int list_parallel_threads(void);
+
+// Combines map(value) for every value, starting from identity. combine
+// must be associative and commutative, since chunks finish in any order.
+// A NULL map uses the values as they are.
+uint64_t list_reduce(List * list, uint64_t identity, uint64_t (*map)(uint16_t),
+                     uint64_t (*combine)(uint64_t, uint64_t));
+// Stores how many times each value occurs in counts[value].
+void list_histogram(List * list, size_t counts[LIST_VALUES]);
+// Creates out holding the values keep() accepts, in list order. Returns 1,
+// or 0 if memory ran out, in which case out is left empty.
+int list_filter(List * list, List * out, bool (*keep)(uint16_t));
+
+// The two below rewrite the values held by the existing nodes: nodes stay
+// where they are and an indexed list's index is rebuilt. They return 1,
+// or 0 if memory ran out or the list was changed during each of a few
+// attempts (the values are then left as they were) or the index could not
+// be rebuilt (the list continues unindexed).
+//
+// Replaces every value with fn(value).
+int list_map(List * list, uint16_t (*fn)(uint16_t));
+// Sorts the values in ascending order. Keys are 16 bits wide, so one
+// counting pass over a parallel histogram is a complete radix sort.
+int list_sort(List * list);
+
+#endif // LIST_PARALLEL_H
@@ -0,0 +1,75 @@
+#include "list_render.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define RENDER_MIN 256
+// Per-thread buffers larger than this are released after each display.
+#define RENDER_KEEP (1 << 20)
+
+const char render_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static __thread RenderBuf render_pool;
+static pthread_key_t render_key;
+static pthread_once_t render_key_once = PTHREAD_ONCE_INIT;
+
+static void render_pool_release(void * arg) {
+    free(((RenderBuf *)arg)->data);
+}
+
+static void render_key_init(void) {
+    pthread_key_create(&render_key, render_pool_release);
+}
+
+RenderBuf * render_pool_get(void) {
+    if (!render_pool.data) {
+        pthread_once(&render_key_once, render_key_init);
+        pthread_setspecific(render_key, &render_pool);
+    }
+    render_pool.len = 0;
+    return &render_pool;
+}
+
+bool render_reserve(RenderBuf * buf, size_t n) {
+    if (buf->len + n <= buf->cap) return true;
+    if (buf->fixed || buf->len > buf->cap) return false;
+
+    size_t cap = buf->cap ? buf->cap : RENDER_MIN;
+    while (cap < buf->len + n) cap *= 2;
+    char * data = realloc(buf->data, cap);
+    if (!data) return false;
+    buf->data = data;
+    buf->cap = cap;
+    return true;
+}
+
+int render_emit(RenderBuf * buf, FILE * stream, int fd) {
+    int result = 0;
+    if (buf->len > buf->cap) {
+        result = -1;
+    } else if (stream) {
+        if (fwrite(buf->data, 1, buf->len, stream) != buf->len) result = -1;
+    } else {
+        size_t done = 0;
+        while (done < buf->len) {
+            ssize_t n = write(fd, buf->data + done, buf->len - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                result = -1;
+                break;
+            }
+            done += (size_t)n;
+        }
+    }
+
+    if (buf == &render_pool && buf->cap > RENDER_KEEP) {
+        free(buf->data);
+        buf->data = NULL;
+        buf->cap = 0;
+    }
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef LIST_RENDER_H
+#define LIST_RENDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Shared display support for the list variants. Output is rendered into a
+// buffer while the list lock is held and written with a single fwrite or
+// write once it is released. A fixed buffer (caller-supplied) never grows;
+// len keeps counting past cap so the caller learns the full length.
+// Otherwise len > cap means the buffer could not be grown.
+typedef struct RenderBuf {
+    char * data;
+    size_t len;
+    size_t cap;
+    bool fixed;
+} RenderBuf;
+
+extern const char render_digit_pairs[];
+
+// Returns the calling thread's reusable buffer, emptied.
+RenderBuf * render_pool_get(void);
+bool render_reserve(RenderBuf * buf, size_t n);
+// Writes buf to stream, or to fd when stream is NULL; 0 on success.
+int render_emit(RenderBuf * buf, FILE * stream, int fd);
+
+// A fixed buffer that fills up keeps the part of bytes that fits, so the
+// output is truncated snprintf-style rather than at the last whole item.
+static inline void render_bytes(RenderBuf * buf, const char * bytes, size_t n) {
+    if (render_reserve(buf, n)) memcpy(buf->data + buf->len, bytes, n);
+    else if (buf->fixed && buf->len < buf->cap) memcpy(buf->data + buf->len, bytes, buf->cap - buf->len);
+    buf->len += n;
+}
+
+// Writes the decimal digits of value so that they end just before out.
+static inline char * render_u16_to_dec(char * out, uint16_t value) {
+    unsigned v = value;
+    while (v >= 100) {
+        out -= 2;
+        memcpy(out, render_digit_pairs + 2 * (v % 100), 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        out -= 2;
+        memcpy(out, render_digit_pairs + 2 * v, 2);
+    } else {
+        *--out = (char)('0' + v);
+    }
+    return out;
+}
+
+// Appends value, preceded by ", " unless it is the first of the range.
+static inline void render_item(RenderBuf * buf, uint16_t value, bool first) {
+    char item[7];  // ", 65535"
+    char * digits = render_u16_to_dec(item + sizeof(item), value);
+    if (!first) {
+        *--digits = ' ';
+        *--digits = ',';
+    }
+    render_bytes(buf, digits, item + sizeof(item) - digits);
+}
+
+#endif // LIST_RENDER_H
@@ -0,0 +1,131 @@
+#include "list_snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+size_t snapshot_bound(int encoding, size_t count) {
+    return encoding == SNAPSHOT_RAW ? 2 * count : 3 * count;
+}
+
+void snapshot_writer_init(SnapshotWriter * writer, uint8_t * data, int encoding) {
+    writer->data = data;
+    writer->len = 0;
+    writer->previous = 0;
+    writer->encoding = encoding;
+}
+
+int snapshot_write(int fd, const SnapshotWriter * writer, size_t count) {
+    SnapshotHeader header = {
+        .version = SNAPSHOT_VERSION,
+        .encoding = (uint8_t)writer->encoding,
+        .count = count,
+        .payload = writer->len,
+    };
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+
+    struct iovec parts[2] = {
+        { &header, sizeof(header) },
+        { writer->data, writer->len },
+    };
+    struct iovec * part = parts;
+    int remaining = writer->len ? 2 : 1;
+    while (remaining > 0) {
+        ssize_t n = writev(fd, part, remaining);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        while (remaining > 0 && (size_t)n >= part->iov_len) {
+            n -= part->iov_len;
+            part++;
+            remaining--;
+        }
+        if (remaining > 0) {
+            part->iov_base = (char *)part->iov_base + n;
+            part->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// Reads a descriptor that cannot be mapped until end of file.
+static int read_all(Snapshot * snap, int fd) {
+    size_t cap = 1 << 16;
+    uint8_t * data = malloc(cap);
+    size_t len = 0;
+    while (data) {
+        if (len == cap) {
+            uint8_t * grown = realloc(data, cap * 2);
+            if (!grown) break;
+            data = grown;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, data + len, cap - len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) break;
+        if (n == 0) {
+            snap->data = data;
+            snap->size = len;
+            snap->mapped = false;
+            return 0;
+        }
+        len += (size_t)n;
+    }
+    free(data);
+    return -1;
+}
+
+int snapshot_open(Snapshot * snap, int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+
+    snap->data = NULL;
+    snap->size = 0;
+    if (S_ISREG(st.st_mode)) {
+        if ((size_t)st.st_size < sizeof(SnapshotHeader)) return -1;
+        void * data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) return -1;
+        // The payload is decoded front to back exactly once.
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        snap->data = data;
+        snap->size = st.st_size;
+        snap->mapped = true;
+    } else if (read_all(snap, fd) != 0) {
+        return -1;
+    }
+
+    const SnapshotHeader * header = &snap->header;
+    if (snap->size < sizeof(SnapshotHeader)) {
+        snapshot_close(snap);
+        return -1;
+    }
+    memcpy(&snap->header, snap->data, sizeof(SnapshotHeader));
+    size_t available = snap->size - sizeof(SnapshotHeader);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != SNAPSHOT_VERSION
+        || (header->encoding != SNAPSHOT_RAW && header->encoding != SNAPSHOT_DELTA)
+        || header->payload > available
+        || header->count > header->payload
+        || (header->encoding == SNAPSHOT_RAW && header->payload != 2 * header->count)) {
+        snapshot_close(snap);
+        return -1;
+    }
+    snap->payload = (const uint8_t *)snap->data + sizeof(SnapshotHeader);
+    return 0;
+}
+
+void snapshot_close(Snapshot * snap) {
+    if (snap->mapped) munmap(snap->data, snap->size);
+    else free(snap->data);
+    snap->data = NULL;
+    snap->size = 0;
+}
+
+void snapshot_reader_init(SnapshotReader * reader, const Snapshot * snap) {
+    reader->pos = snap->payload;
+    reader->end = snap->payload + snap->header.payload;
+    reader->previous = 0;
+    reader->encoding = snap->header.encoding;
+}
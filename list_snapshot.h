@@ -0,0 +1,111 @@
+#ifndef LIST_SNAPSHOT_H
+#define LIST_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Binary list snapshots: a fixed header followed by the values in list
+// order. SNAPSHOT_RAW stores each value as two little-endian bytes.
+// SNAPSHOT_DELTA stores the difference from the previous value, zigzag
+// mapped and varint encoded (LEB128), so runs of close values take one
+// byte each and no value takes more than three.
+#define SNAPSHOT_MAGIC "DVLS"
+#define SNAPSHOT_VERSION 1
+
+enum { SNAPSHOT_RAW = 0, SNAPSHOT_DELTA = 1 };
+
+// Header fields are stored in the host's byte order.
+typedef struct SnapshotHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t encoding;
+    uint16_t reserved;
+    uint64_t count;    // Values in the payload
+    uint64_t payload;  // Payload bytes following the header
+} SnapshotHeader;
+
+// Encoder state. data must hold snapshot_bound(encoding, count) bytes.
+typedef struct SnapshotWriter {
+    uint8_t * data;
+    size_t len;
+    uint16_t previous;
+    int encoding;
+} SnapshotWriter;
+
+// An opened snapshot. Regular files are mapped read-only and decoded in
+// place; other descriptors (pipes, sockets) are read into a buffer.
+typedef struct Snapshot {
+    SnapshotHeader header;
+    const uint8_t * payload;
+    void * data;
+    size_t size;
+    bool mapped;
+} Snapshot;
+
+typedef struct SnapshotReader {
+    const uint8_t * pos;
+    const uint8_t * end;
+    uint16_t previous;
+    int encoding;
+} SnapshotReader;
+
+// Largest payload count values can take with encoding.
+size_t snapshot_bound(int encoding, size_t count);
+void snapshot_writer_init(SnapshotWriter * writer, uint8_t * data, int encoding);
+// Writes the header and the writer's payload with a single writev call
+// (repeated only if the kernel takes it in pieces); 0 on success, -1 on a
+// write error.
+int snapshot_write(int fd, const SnapshotWriter * writer, size_t count);
+// Reads a snapshot starting at the descriptor's beginning (regular files)
+// or current position (others) and checks its header; 0 on success, -1
+// if it cannot be read or is not a snapshot. Release it with
+// snapshot_close.
+int snapshot_open(Snapshot * snap, int fd);
+void snapshot_close(Snapshot * snap);
+void snapshot_reader_init(SnapshotReader * reader, const Snapshot * snap);
+
+static inline void snapshot_put(SnapshotWriter * writer, uint16_t value) {
+    uint8_t * out = writer->data + writer->len;
+    if (writer->encoding == SNAPSHOT_RAW) {
+        out[0] = (uint8_t)value;
+        out[1] = (uint8_t)(value >> 8);
+        writer->len += 2;
+        return;
+    }
+    int32_t delta = (int32_t)value - writer->previous;
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    while (zigzag >= 0x80) {
+        *out++ = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    *out++ = (uint8_t)zigzag;
+    writer->len = out - writer->data;
+    writer->previous = value;
+}
+
+// Decodes the next value; false if the payload is exhausted or malformed.
+static inline bool snapshot_get(SnapshotReader * reader, uint16_t * value) {
+    const uint8_t * in = reader->pos;
+    if (reader->encoding == SNAPSHOT_RAW) {
+        if (reader->end - in < 2) return false;
+        *value = (uint16_t)(in[0] | in[1] << 8);
+        reader->pos = in + 2;
+        return true;
+    }
+    uint32_t zigzag = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (in == reader->end || shift > 14) return false;
+        uint8_t byte = *in++;
+        zigzag |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    int32_t decoded = reader->previous + ((int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1));
+    if (decoded < 0 || decoded > UINT16_MAX) return false;
+    reader->pos = in;
+    reader->previous = (uint16_t)decoded;
+    *value = (uint16_t)decoded;
+    return true;
+}
+
+#endif // LIST_SNAPSHOT_H
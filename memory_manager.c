@@ -1,174 +1,1545 @@
+#define _GNU_SOURCE  // mremap, getcpu
 #include "memory_manager.h"
+#include "executor.h"
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <pthread.h>
-/*adsadasdadas*/
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+/*
+ * Block metadata lives outside the pool so that a pool of N bytes can hand
+ * out exactly N bytes. Every block is on the address-ordered block list
+ * (prev/next); free blocks are additionally on the free list and allocated
+ * blocks are reachable through the pointer table, so mem_free never walks.
+ */
 typedef struct Block {
     void* ptr;
     size_t size;
     int free;
+    struct Block* prev;
     struct Block* next;
+    struct Block* free_prev;
+    struct Block* free_next;
 } Block;
 
+#define BLOCK_CHUNK 1024
+#define TABLE_MIN_CAPACITY 64
+
+typedef struct BlockChunk {
+    struct BlockChunk* next;
+    Block blocks[BLOCK_CHUNK];
+} BlockChunk;
+
 static void* memory_pool = NULL;
 static Block* block_list = NULL;
 static size_t memory_pool_size = 0;
-static size_t total_used = 0;
 
-static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+// Spare Block structs are carved out of chunks instead of one malloc each.
+static BlockChunk* block_chunks = NULL;
+static Block* spare_blocks = NULL;
+
+// Open addressing table from user pointer to allocated Block.
+static Block** table = NULL;
+static size_t table_capacity = 0;
+static size_t table_count = 0;
+
+/*
+ * The allocator lock (sync_lock.h) also guards the list code that calls
+ * mem_lock; its counters report allocator contention in MemStats.
+ */
+static SyncLock lock = SYNC_LOCK_INIT;
+
+/*
+ * File-backed pools (mem_init_file) map the file as
+ *   [PoolFileHeader, padded to POOL_FILE_HEADER][pool][block trailer]
+ * The trailer is written by mem_deinit: one uint64 per block, in address
+ * order, holding size << 1 | free. Offsets follow from the sizes, so
+ * nothing in the file depends on where it is mapped. clean is cleared
+ * while the pool is open and set again only after the pool and trailer
+ * have reached the disk.
+ */
+#define POOL_FILE_MAGIC "DVPOOL01"
+#define POOL_FILE_HEADER 4096
+
+typedef struct PoolFileHeader {
+    char magic[8];
+    uint64_t pool_size;
+    uint64_t block_count;
+    uint32_t root;
+    uint32_t clean;
+} PoolFileHeader;
+
+/*
+ * Page release: once release_threshold bytes have been freed since the last
+ * pass, a task on the shared executor madvises away the whole pages inside
+ * free blocks of at least RELEASE_MIN_BYTES. Only one task is queued at a
+ * time; mem_deinit waits for it through maintenance.
+ */
+#define RELEASE_MIN_BYTES (256 * 1024)
+
+static size_t release_threshold = 0;
+static size_t freed_since_release = 0;
+static size_t released_bytes = 0;
+static int release_pending = 0;
+static Executor* maintenance_executor = NULL;
+static ExecutorGroup maintenance = EXECUTOR_GROUP_INIT;
+
+/*
+ * Background maintenance (mem_start_maintenance). A thread takes the lock
+ * once per interval for a bounded tick: it files up to MAINT_TICK_BLOCKS
+ * more blocks of the free list into the size-class bins, noting the
+ * largest seen in the pass. Frees and
+ * split remainders are filed as they happen. Class c holds free blocks of
+ * at least 2^c bytes, so an allocation takes the first live entry from the
+ * smallest class that is sure to fit instead of scanning the free list.
+ * Entries are hints: one is used only if its Block is still free and big
+ * enough, and released Blocks are zeroed so that they never are.
+ */
+#define BIN_CLASSES 48
+#define BIN_SLOTS 32
+#define MAINT_TICK_BLOCKS 64
+
+static Block* bins[BIN_CLASSES][BIN_SLOTS];
+static int bin_count[BIN_CLASSES];
+static int bin_next[BIN_CLASSES];  // Slot the next entry goes to
+static Block* maint_cursor = NULL;   // Where the current pass resumes
+static Block* pass_largest = NULL;
+static Block* largest_block = NULL;  // Largest free block of the last pass
+static int maintenance_on = 0;
+static unsigned maintenance_interval_us = 0;
+static pthread_t maintenance_thread;
+// The thread sleeps on its own mutex, since the allocator lock has no
+// condition variable; maintenance_stop is guarded by it.
+static pthread_mutex_t maintenance_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t maintenance_wake = PTHREAD_COND_INITIALIZER;
+static int maintenance_stop = 0;
+
+/*
+ * Remote frees (mem_free_remote). A thread collects the blocks it frees
+ * into a thread-local batch and publishes each full batch onto
+ * remote_batches with one compare-and-swap, never taking the lock. The
+ * next thread to take the lock for an allocation detaches the whole stack
+ * with one exchange and frees the batches while it holds the lock anyway.
+ * Batches are stamped with the pool generation they were started in, so
+ * blocks queued for a pool that has since been deinitialised are dropped
+ * rather than freed into its successor.
+ */
+#define REMOTE_BATCH 256
+
+typedef struct RemoteBatch {
+    struct RemoteBatch* next;
+    unsigned long generation;
+    size_t count;
+    void* blocks[REMOTE_BATCH];
+} RemoteBatch;
+
+static RemoteBatch* remote_batches = NULL;
+// Bumped by mem_deinit; also checked by the size-class caches.
+unsigned long mem_pool_generation = 0;
+static __thread RemoteBatch* local_batch = NULL;
+static pthread_key_t remote_key;
+static pthread_once_t remote_key_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Known-zero pages, for mem_calloc. A heap pool starts out zeroed, so
+ * every page begins marked; freeing a block unmarks the pages it covers,
+ * since its owner may have written them, and madvising pages away marks
+ * them again. A block carved from free space is therefore zero on every
+ * marked page it touches, and only the rest needs a memset. Pages are
+ * numbered by address, so a page the pool shares with other memory still
+ * has a bit, which speaks only for the pool's bytes in it. Bits are
+ * changed and read atomically: mem_calloc reads them for its own block
+ * after dropping the lock, and only pages wholly inside free blocks are
+ * ever marked. File pools have no bitmap and are always cleared.
+ */
+static uint64_t* zero_pages = NULL;
+static uintptr_t zero_first_page = 0;
+static size_t zero_page_words = 0;
+static unsigned page_shift = 12;
+
+/*
+ * Large blocks (mem_set_large_threshold). A request of at least
+ * large_threshold bytes gets a private anonymous mapping of its own
+ * instead of pool space, so it never fragments the pool, and the mapping
+ * goes back to the kernel when the block is freed. There are few of them,
+ * so they sit in a small unsorted array; a pointer outside the pool is
+ * what sends mem_free there. mem_resize grows them with mremap, which
+ * moves page table entries instead of copying the contents.
+ */
+typedef struct LargeBlock {
+    void* ptr;
+    size_t size;
+    size_t length;  // Mapped bytes, a whole number of pages
+} LargeBlock;
+
+static size_t large_threshold = 0;
+static LargeBlock* large_blocks = NULL;
+static size_t large_count = 0;
+static size_t large_capacity = 0;
+
+/*
+ * NUMA segments (mem_init_numa). The pool is one anonymous mapping split
+ * into page-aligned segments, each bound to a node with mbind, and a free
+ * block never spans two of them: they start out as separate blocks and
+ * frees and in-place growth do not merge across a boundary. Every segment
+ * has its own free list, and allocations (runs and class refills
+ * included) search the lists of segments on the calling thread's node
+ * before the others, so a miss still looks at each free block once. The
+ * thread's node is asked of getcpu only every NODE_REFRESH lookups, which
+ * lets a migrated thread catch up without a call per allocation. The
+ * system calls are made directly, so there is no libnuma dependency; with
+ * a single node online nothing is bound and the segments only keep the
+ * split. Outside NUMA mode the whole pool is segment 0, on node -1.
+ */
+#define NODE_REFRESH 1024
+
+static int segment_count = 1;
+static size_t segment_start[MEM_MAX_NODES];  // Offsets into the pool
+static int segment_node[MEM_MAX_NODES] = { -1 };
+static Block* free_lists[MEM_MAX_NODES];
+static int pool_mapped = 0;  // Pool comes from mmap rather than calloc
+static __thread int thread_node = -1;
+static __thread unsigned thread_node_age = 0;
+
+static int pool_fd = -1;
+static PoolFileHeader* pool_header = NULL;  // Start of the mapping
+static uint32_t heap_root = MEM_NO_OFFSET;
+
+static Block* block_new(void) {
+    if (!spare_blocks) {
+        BlockChunk* chunk = malloc(sizeof(BlockChunk));
+        if (!chunk) return NULL;
+        chunk->next = block_chunks;
+        block_chunks = chunk;
+        for (size_t i = 0; i < BLOCK_CHUNK; i++) {
+            chunk->blocks[i].next = spare_blocks;
+            spare_blocks = &chunk->blocks[i];
+        }
+    }
+    Block* block = spare_blocks;
+    spare_blocks = block->next;
+    return block;
+}
+
+static void block_release(Block* block) {
+    block->free = 0;
+    block->size = 0;
+    block->next = spare_blocks;
+    spare_blocks = block;
+}
+
+static size_t table_slot(void* ptr) {
+    uintptr_t key = (uintptr_t)ptr;
+    key ^= key >> 33;
+    key *= (uintptr_t)0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key & (table_capacity - 1);
+}
+
+static int table_grow(void) {
+    size_t capacity = table_capacity ? table_capacity * 2 : TABLE_MIN_CAPACITY;
+    Block** old = table;
+    size_t old_capacity = table_capacity;
+
+    table = calloc(capacity, sizeof(Block*));
+    if (!table) {
+        table = old;
+        return 0;
+    }
+    table_capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old[i]) continue;
+        size_t slot = table_slot(old[i]->ptr);
+        while (table[slot]) slot = (slot + 1) & (table_capacity - 1);
+        table[slot] = old[i];
+    }
+    free(old);
+    return 1;
+}
+
+// Makes sure one more block can be inserted without growing the table.
+static int table_reserve(void) {
+    return (table_count + 1) * 2 <= table_capacity || table_grow();
+}
+
+static int table_insert(Block* block) {
+    if (!table_reserve()) return 0;
+
+    size_t slot = table_slot(block->ptr);
+    while (table[slot]) slot = (slot + 1) & (table_capacity - 1);
+    table[slot] = block;
+    table_count++;
+    return 1;
+}
+
+static Block* table_find(void* ptr, size_t* out_slot) {
+    if (!table) return NULL;
+
+    size_t slot = table_slot(ptr);
+    while (table[slot]) {
+        if (table[slot]->ptr == ptr) {
+            if (out_slot) *out_slot = slot;
+            return table[slot];
+        }
+        slot = (slot + 1) & (table_capacity - 1);
+    }
+    return NULL;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones.
+static void table_remove_slot(size_t slot) {
+    size_t mask = table_capacity - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+
+    while (table[next]) {
+        size_t home = table_slot(table[next]->ptr);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            table[hole] = table[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    table[hole] = NULL;
+    table_count--;
+}
+
+static size_t segment_end(int segment) {
+    return segment + 1 < segment_count ? segment_start[segment + 1] : memory_pool_size;
+}
+
+static int segment_of(const void* ptr) {
+    size_t offset = (size_t)((uintptr_t)ptr - (uintptr_t)memory_pool);
+    int segment = 0;
+    while (segment + 1 < segment_count && offset >= segment_start[segment + 1]) segment++;
+    return segment;
+}
+
+static int same_segment(const Block* a, const Block* b) {
+    return segment_count == 1 || segment_of(a->ptr) == segment_of(b->ptr);
+}
+
+// The calling thread's node, or segment 0's outside NUMA mode.
+static int local_node(void) {
+    if (segment_count == 1) return segment_node[0];
+    if (thread_node < 0 || ++thread_node_age >= NODE_REFRESH) {
+        unsigned cpu, node;
+        thread_node = getcpu(&cpu, &node) == 0 ? (int)node : -1;
+        thread_node_age = 0;
+    }
+    return thread_node;
+}
+
+static void free_list_push(Block* block) {
+    Block** head = &free_lists[segment_of(block->ptr)];
+    block->free_prev = NULL;
+    block->free_next = *head;
+    if (*head) (*head)->free_prev = block;
+    *head = block;
+}
+
+static void free_list_remove(Block* block) {
+    if (block->free_prev) block->free_prev->free_next = block->free_next;
+    else free_lists[segment_of(block->ptr)] = block->free_next;
+    if (block->free_next) block->free_next->free_prev = block->free_prev;
+    block->free_prev = NULL;
+    block->free_next = NULL;
+}
+
+// The free list walk across segments, in segment order: the first free
+// block, and the one after block.
+static Block* free_first(void) {
+    for (int i = 0; i < segment_count; i++) {
+        if (free_lists[i]) return free_lists[i];
+    }
+    return NULL;
+}
+
+static Block* free_after(const Block* block) {
+    if (block->free_next) return block->free_next;
+    for (int i = segment_of(block->ptr) + 1; i < segment_count; i++) {
+        if (free_lists[i]) return free_lists[i];
+    }
+    return NULL;
+}
+
+/*
+ * First fit of size bytes, searching the segments on node before the
+ * others. If largest is given, it is left pointing at the largest block
+ * seen when nothing fits.
+ */
+static Block* first_fit(size_t size, int node, Block** largest) {
+    for (int local = 1; local >= 0; local--) {
+        for (int i = 0; i < segment_count; i++) {
+            if ((segment_node[i] == node) != local) continue;
+            for (Block* current = free_lists[i]; current; current = current->free_next) {
+                if (current->size >= size) return current;
+                if (largest && (!*largest || current->size > (*largest)->size)) *largest = current;
+            }
+        }
+    }
+    return NULL;
+}
+
+static int bin_class(size_t size) {
+    int c = 63 - __builtin_clzl(size);
+    return c < BIN_CLASSES ? c : BIN_CLASSES - 1;
+}
+
+static int block_fits(const Block* block, size_t size) {
+    return block && block->free && block->size >= size && block->size > 0;
+}
+
+// Files a free block. Each class is a ring: when it is full the oldest
+// entry is overwritten, so filing never has to look at other Blocks.
+static void bin_add(Block* block) {
+    int c = bin_class(block->size);
+    for (int i = 0; i < bin_count[c]; i++) {
+        if (bins[c][i] == block) return;
+    }
+    bins[c][bin_next[c]] = block;
+    bin_next[c] = (bin_next[c] + 1) % BIN_SLOTS;
+    if (bin_count[c] < BIN_SLOTS) bin_count[c]++;
+}
+
+// Takes the most recently filed live block of at least size bytes in a
+// segment on node, or returns NULL. Entries passed over for another node
+// are dropped like dead ones; the next pass files them again.
+static Block* bin_take(size_t size, int node) {
+    int c = size > 1 ? bin_class(size - 1) + 1 : 0;
+    for (; c < BIN_CLASSES; c++) {
+        while (bin_count[c] > 0) {
+            bin_next[c] = (bin_next[c] + BIN_SLOTS - 1) % BIN_SLOTS;
+            bin_count[c]--;
+            Block* block = bins[c][bin_next[c]];
+            if (block_fits(block, size) && segment_node[segment_of(block->ptr)] == node) return block;
+        }
+    }
+    return NULL;
+}
+
+static void bins_clear(void) {
+    memset(bin_count, 0, sizeof(bin_count));
+    memset(bin_next, 0, sizeof(bin_next));
+    maint_cursor = NULL;
+    pass_largest = NULL;
+    largest_block = NULL;
+}
+
+static void maintenance_tick_unlocked(void) {
+    // Any free Block is on the free list, so a cursor that is still free is
+    // a safe place to resume; otherwise a new pass starts.
+    Block* current = block_fits(maint_cursor, 1) ? maint_cursor : NULL;
+    if (!current) {
+        if (block_fits(pass_largest, 1)) largest_block = pass_largest;
+        pass_largest = NULL;
+        current = free_first();
+    }
+    for (int n = 0; current && n < MAINT_TICK_BLOCKS; n++, current = free_after(current)) {
+        bin_add(current);
+        if (!block_fits(pass_largest, current->size)) pass_largest = current;
+    }
+    maint_cursor = current;
+}
+
+// Absorb next into block; both are adjacent on the block list.
+static void block_merge_next(Block* block) {
+    Block* next = block->next;
+    block->size += next->size;
+    block->next = next->next;
+    if (next->next) next->next->prev = block;
+    block_release(next);
+}
+
+// Carves size bytes off the front of the free block current; the rest stays
+// free right after it. Returns 0 if block metadata ran out, with the pool
+// left as it was: the table slot is reserved before anything is split.
+static int take_block(Block* current, size_t size) {
+    if (!table_reserve()) return 0;
+    size_t leftover = current->size - size;
+    if (leftover > 0) {
+        Block* rest = block_new();
+        if (!rest) return 0;
+
+        rest->ptr = (char*)current->ptr + size;
+        rest->size = leftover;
+        rest->free = 1;
+        rest->prev = current;
+        rest->next = current->next;
+        if (current->next) current->next->prev = rest;
+        current->next = rest;
+        current->size = size;
+
+        // The remainder takes over current's place on the free list.
+        rest->free_prev = current->free_prev;
+        rest->free_next = current->free_next;
+        if (rest->free_prev) rest->free_prev->free_next = rest;
+        else free_lists[segment_of(rest->ptr)] = rest;
+        if (rest->free_next) rest->free_next->free_prev = rest;
+        current->free_prev = NULL;
+        current->free_next = NULL;
+        if (maintenance_on) bin_add(rest);
+    } else {
+        free_list_remove(current);
+    }
+
+    current->free = 0;
+    table_insert(current);  // Cannot fail after table_reserve
+    return 1;
+}
+
+static int in_pool(const void* ptr) {
+    return memory_pool && (uintptr_t)ptr >= (uintptr_t)memory_pool
+        && (uintptr_t)ptr - (uintptr_t)memory_pool < memory_pool_size;
+}
+
+// File pools keep every block in the file, so they have no large blocks.
+static int large_wanted(size_t size) {
+    return large_threshold && size >= large_threshold && pool_fd < 0 && memory_pool;
+}
+
+// Rounds size up to whole pages, or returns 0 if that overflows.
+static size_t large_length(size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return size > SIZE_MAX - (page - 1) ? 0 : (size + page - 1) & ~(page - 1);
+}
+
+static LargeBlock* large_find_unlocked(const void* ptr) {
+    for (size_t i = 0; i < large_count; i++) {
+        if (large_blocks[i].ptr == ptr) return &large_blocks[i];
+    }
+    return NULL;
+}
+
+static void* large_alloc_unlocked(size_t size) {
+    size_t length = large_length(size);
+    if (length == 0) return NULL;
+    if (large_count == large_capacity) {
+        size_t capacity = large_capacity ? large_capacity * 2 : 16;
+        LargeBlock* grown = realloc(large_blocks, capacity * sizeof(LargeBlock));
+        if (!grown) return NULL;
+        large_blocks = grown;
+        large_capacity = capacity;
+    }
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+    large_blocks[large_count++] = (LargeBlock){ ptr, size, length };
+    return ptr;
+}
+
+// Forgets the block and returns its mapped length, 0 if ptr is not one.
+static size_t large_remove_unlocked(void* ptr) {
+    LargeBlock* entry = large_find_unlocked(ptr);
+    if (!entry) return 0;
+    size_t length = entry->length;
+    *entry = large_blocks[--large_count];
+    return length;
+}
+
+static void* alloc_unlocked(size_t size) {
+    if (large_wanted(size)) return large_alloc_unlocked(size);
+
+    // A zero-byte request does not consume a block.
+    if (size == 0) {
+        Block* first = free_first();
+        return first ? first->ptr : NULL;
+    }
+
+    int node = local_node();
+    Block* current = maintenance_on ? bin_take(size, node) : NULL;
+    if (!current) current = first_fit(size, node, NULL);
+    if (!current || !take_block(current, size)) return NULL;
+    return current->ptr;
+}
+
+// Places the block right after hint's block when that space is free.
+static void* alloc_near_unlocked(void* hint, size_t size) {
+    if (large_wanted(size)) return large_alloc_unlocked(size);
+    Block* owner = hint && size ? table_find(hint, NULL) : NULL;
+    Block* next = owner ? owner->next : NULL;
+    if (next && next->free && next->size >= size) {
+        return take_block(next, size) ? next->ptr : NULL;
+    }
+    return alloc_unlocked(size);
+}
+
+// Marks (zero != 0) or unmarks the pages holding [ptr, ptr + size).
+static void zero_pages_mark(const void* ptr, size_t size, int zero) {
+    if (!zero_pages || size == 0) return;
+    size_t first = ((uintptr_t)ptr >> page_shift) - zero_first_page;
+    size_t last = (((uintptr_t)ptr + size - 1) >> page_shift) - zero_first_page;
+    for (size_t word = first / 64; word <= last / 64; word++) {
+        size_t low = word == first / 64 ? first % 64 : 0;
+        size_t high = word == last / 64 ? last % 64 : 63;
+        uint64_t bits = (high == 63 ? ~(uint64_t)0 : ((uint64_t)1 << (high + 1)) - 1) & ~(((uint64_t)1 << low) - 1);
+        if (zero) __atomic_fetch_or(&zero_pages[word], bits, __ATOMIC_RELAXED);
+        else __atomic_fetch_and(&zero_pages[word], ~bits, __ATOMIC_RELAXED);
+    }
+}
+
+// Sets up the bitmap for a freshly zeroed heap pool, all pages marked.
+static int zero_pages_init(void) {
+    page_shift = (unsigned)__builtin_ctzl((unsigned long)sysconf(_SC_PAGESIZE));
+    zero_first_page = (uintptr_t)memory_pool >> page_shift;
+    size_t pages = (((uintptr_t)memory_pool + memory_pool_size - 1) >> page_shift) - zero_first_page + 1;
+    zero_page_words = (pages + 63) / 64;
+    zero_pages = malloc(zero_page_words * sizeof(uint64_t));
+    if (!zero_pages) return 0;
+    memset(zero_pages, 0xff, zero_page_words * sizeof(uint64_t));
+    return 1;
+}
+
+static size_t release_free_pages_unlocked(void) {
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    size_t released = 0;
+    for (Block* current = free_first(); current; current = free_after(current)) {
+        if (current->size < RELEASE_MIN_BYTES) continue;
+        uintptr_t start = ((uintptr_t)current->ptr + page - 1) & ~(page - 1);
+        uintptr_t end = ((uintptr_t)current->ptr + current->size) & ~(page - 1);
+        if (end > start && madvise((void*)start, end - start, MADV_DONTNEED) == 0) {
+            released += end - start;
+            zero_pages_mark((void*)start, end - start, 1);
+        }
+    }
+    released_bytes += released;
+    return released;
+}
+
+static void release_task(void* unused) {
+    (void)unused;
+    sync_lock(&lock);
+    release_pending = 0;
+    if (memory_pool) release_free_pages_unlocked();
+    sync_unlock(&lock);
+}
+
+static void schedule_release_unlocked(void) {
+    Executor* executor = executor_shared();
+    if (!executor) return;
+    freed_since_release = 0;
+    if (executor_try_submit(executor, &maintenance, release_task, NULL) == 0) {
+        release_pending = 1;
+        maintenance_executor = executor;
+    }
+}
+
+static void free_unlocked(void* ptr) {
+    if (!in_pool(ptr)) {
+        size_t length = large_remove_unlocked(ptr);
+        if (length) munmap(ptr, length);
+        return;
+    }
+
+    size_t slot;
+    Block* block = table_find(ptr, &slot);
+    if (!block) return;  // Unknown pointer or double free
+
+    table_remove_slot(slot);
+    zero_pages_mark(block->ptr, block->size, 0);
+    block->free = 1;
+    freed_since_release += block->size;
+    if (release_threshold && freed_since_release >= release_threshold && !release_pending) {
+        schedule_release_unlocked();
+    }
+
+    if (block->next && block->next->free && same_segment(block, block->next)) {
+        free_list_remove(block->next);
+        block_merge_next(block);
+    }
+    if (block->prev && block->prev->free && same_segment(block, block->prev)) {
+        Block* prev = block->prev;
+        free_list_remove(prev);
+        block_merge_next(prev);
+        block = prev;
+    }
+    free_list_push(block);
+    if (maintenance_on) bin_add(block);
+}
+
+// Makes each segment one free block.
+static int pool_reset_unlocked(void) {
+    Block* blocks[MEM_MAX_NODES];
+    for (int i = 0; i < segment_count; i++) {
+        blocks[i] = block_new();
+        if (!blocks[i]) return 0;
+    }
+
+    memset(free_lists, 0, sizeof(free_lists));
+    for (int i = 0; i < segment_count; i++) {
+        blocks[i]->ptr = (char*)memory_pool + segment_start[i];
+        blocks[i]->size = segment_end(i) - segment_start[i];
+        blocks[i]->free = 1;
+        blocks[i]->prev = i > 0 ? blocks[i - 1] : NULL;
+        blocks[i]->next = i + 1 < segment_count ? blocks[i + 1] : NULL;
+        free_list_push(blocks[i]);
+    }
+    block_list = blocks[0];
+    return 1;
+}
 
 void mem_init(size_t size) {
-    pthread_mutex_lock(&lock);
+    sync_lock(&lock);
 
-    memory_pool = malloc(size);
+    // calloc hands back fresh mappings without writing them, and the zero
+    // page bitmap lets mem_calloc rely on that.
+    memory_pool = calloc(1, size);
     if (!memory_pool) {
         fprintf(stderr, "Failed to allocate memory pool\n");
-        pthread_mutex_unlock(&lock);
+        sync_unlock(&lock);
         return;
     }
 
-    block_list = malloc(sizeof(Block));
-    if (!block_list) {
+    memory_pool_size = size;
+    heap_root = MEM_NO_OFFSET;
+    if (!zero_pages_init() || !pool_reset_unlocked()) {
+        free(zero_pages);
+        zero_pages = NULL;
         free(memory_pool);
         memory_pool = NULL;
+        memory_pool_size = 0;
         fprintf(stderr, "Failed to allocate metadata block\n");
-        pthread_mutex_unlock(&lock);
-        return;
     }
 
-    block_list->ptr = memory_pool;
-    block_list->size = size;
-    block_list->free = 1;
-    block_list->next = NULL;
+    sync_unlock(&lock);
+}
+
+// Reads the online node list ("0" or "0,2-3"), keeping at most max.
+// Returns how many were stored, with node 0 standing in if it is missing.
+static int online_nodes(int* nodes, int max) {
+    int count = 0;
+    FILE* file = fopen("/sys/devices/system/node/online", "r");
+    if (file) {
+        int first, last;
+        while (count < max && fscanf(file, "%d", &first) == 1) {
+            last = first;
+            int c = fgetc(file);
+            if (c == '-') {
+                if (fscanf(file, "%d", &last) != 1) break;
+                c = fgetc(file);
+            }
+            for (int node = first; node <= last && count < max; node++) {
+                nodes[count++] = node;
+            }
+            if (c != ',') break;
+        }
+        fclose(file);
+    }
+    if (count == 0) nodes[count++] = 0;
+    return count;
+}
+
+// Prefers node for the pages of [start, start + length). Returns 0 if the
+// kernel refused, in which case the pages go wherever they are touched.
+static int bind_to_node(void* start, size_t length, int node) {
+    unsigned long mask[(MEM_MAX_NODE_ID + 1 + 63) / 64] = { 0 };
+    if (node > MEM_MAX_NODE_ID) return 0;
+    mask[node / 64] |= 1UL << (node % 64);
+    return syscall(SYS_mbind, start, length, MPOL_PREFERRED, mask, MEM_MAX_NODE_ID + 1, 0) == 0;
+}
+
+int mem_init_numa(size_t size, int segments) {
+    sync_lock(&lock);
+
+    int nodes[MEM_MAX_NODES];
+    int node_count = online_nodes(nodes, MEM_MAX_NODES);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    int count = segments > 0 ? segments : node_count;
+    if (count > MEM_MAX_NODES) count = MEM_MAX_NODES;
+    size = size > SIZE_MAX - (page - 1) ? 0 : (size + page - 1) & ~(page - 1);
+    while (count > 1 && size / (size_t)count < page) count--;
+
+    void* map = size ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to allocate memory pool\n");
+        sync_unlock(&lock);
+        return -1;
+    }
+
+    memory_pool = map;
+    memory_pool_size = size;
+    pool_mapped = 1;
+    segment_count = count;
+    size_t length = (size / (size_t)count) & ~(page - 1);
+    for (int i = 0; i < count; i++) {
+        segment_start[i] = (size_t)i * length;
+        segment_node[i] = nodes[i % node_count];
+        // One node holds everything anyway, so there is nothing to bind.
+        if (node_count > 1 && !bind_to_node((char*)map + segment_start[i], segment_end(i) - segment_start[i], segment_node[i])) {
+            segment_node[i] = -1;
+        }
+    }
+
+    heap_root = MEM_NO_OFFSET;
+    if (!zero_pages_init() || !pool_reset_unlocked()) {
+        free(zero_pages);
+        zero_pages = NULL;
+        munmap(map, size);
+        memory_pool = NULL;
+        memory_pool_size = 0;
+        pool_mapped = 0;
+        segment_count = 1;
+        segment_node[0] = -1;
+        fprintf(stderr, "Failed to allocate metadata block\n");
+        sync_unlock(&lock);
+        return -1;
+    }
+
+    sync_unlock(&lock);
+    return count;
+}
+
+// Rebuilds the block list, free list and table from a trailer.
+static int pool_restore_unlocked(const uint64_t* records, size_t count) {
+    while (table_capacity < count * 2) {
+        if (!table_grow()) return 0;
+    }
+
+    size_t offset = 0;
+    Block* previous = NULL;
+    memset(free_lists, 0, sizeof(free_lists));
+    for (size_t i = 0; i < count; i++) {
+        Block* block = block_new();
+        if (!block) return 0;
+        block->ptr = (char*)memory_pool + offset;
+        block->size = records[i] >> 1;
+        block->free = records[i] & 1;
+        block->prev = previous;
+        block->next = NULL;
+        if (previous) previous->next = block;
+        else block_list = block;
+        previous = block;
+        offset += block->size;
+
+        if (block->free) free_list_push(block);
+        else if (!table_insert(block)) return 0;
+    }
+    return 1;
+}
+
+// Reads and checks the trailer of a cleanly closed pool file.
+static uint64_t* pool_read_trailer(int fd, const PoolFileHeader* header) {
+    size_t count = header->block_count;
+    uint64_t* records = malloc(count * sizeof(uint64_t) + 1);
+    if (!records) return NULL;
+
+    size_t bytes = count * sizeof(uint64_t);
+    off_t at = POOL_FILE_HEADER + (off_t)header->pool_size;
+    if (pread(fd, records, bytes, at) != (ssize_t)bytes) {
+        free(records);
+        return NULL;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += records[i] >> 1;
+    }
+    if (count == 0 || total != header->pool_size) {
+        free(records);
+        return NULL;
+    }
+    return records;
+}
+
+int mem_init_file(const char* path, size_t size) {
+    sync_lock(&lock);
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open pool file %s\n", path);
+        sync_unlock(&lock);
+        return -1;
+    }
+
+    PoolFileHeader header;
+    struct stat st;
+    int reopen = fstat(fd, &st) == 0 && st.st_size >= POOL_FILE_HEADER &&
+                 pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                 memcmp(header.magic, POOL_FILE_MAGIC, sizeof(header.magic)) == 0;
+
+    uint64_t* records = NULL;
+    if (reopen) {
+        if (!header.clean) {
+            fprintf(stderr, "Pool file %s was not shut down cleanly\n", path);
+            close(fd);
+            sync_unlock(&lock);
+            return -1;
+        }
+        size = header.pool_size;
+        records = pool_read_trailer(fd, &header);
+        if (!records) {
+            fprintf(stderr, "Pool file %s has a damaged block table\n", path);
+            close(fd);
+            sync_unlock(&lock);
+            return -1;
+        }
+    } else if (size == 0 || ftruncate(fd, POOL_FILE_HEADER + (off_t)size) != 0) {
+        fprintf(stderr, "Failed to size pool file %s\n", path);
+        close(fd);
+        sync_unlock(&lock);
+        return -1;
+    }
 
+    void* map = mmap(NULL, POOL_FILE_HEADER + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map pool file %s\n", path);
+        free(records);
+        close(fd);
+        sync_unlock(&lock);
+        return -1;
+    }
+
+    memory_pool = (char*)map + POOL_FILE_HEADER;
     memory_pool_size = size;
-    total_used = size + sizeof(Block);
+    int ok = reopen ? pool_restore_unlocked(records, header.block_count) : pool_reset_unlocked();
+    free(records);
+    if (!ok) {
+        fprintf(stderr, "Failed to allocate metadata block\n");
+        munmap(map, POOL_FILE_HEADER + size);
+        close(fd);
+        memory_pool = NULL;
+        memory_pool_size = 0;
+        sync_unlock(&lock);
+        return -1;
+    }
 
-    pthread_mutex_unlock(&lock);
+    pool_header = map;
+    if (!reopen) {
+        memcpy(pool_header->magic, POOL_FILE_MAGIC, sizeof(pool_header->magic));
+        pool_header->pool_size = size;
+        pool_header->block_count = 0;
+        pool_header->root = MEM_NO_OFFSET;
+    }
+    // From here on a crash leaves the file marked unclean.
+    pool_header->clean = 0;
+    msync(pool_header, POOL_FILE_HEADER, MS_SYNC);
+    pool_fd = fd;
+
+    sync_unlock(&lock);
+    return reopen;
 }
 
-void* mem_alloc(size_t size) {
-    pthread_mutex_lock(&lock);
-
-    Block* current = block_list;
-
-    // First-fit strategy
-    while (current) {
-        if (current->free && current->size >= size) {
-            size_t leftover = current->size - size;
-
-            // Only split if it's worth it
-            if (leftover >= sizeof(Block) + 16) {
-                // Prevent metadata explosion
-                if (total_used + sizeof(Block) > memory_pool_size + memory_pool_size / 5) {
-                    current->free = 0;  // Use whole block without split
-                    pthread_mutex_unlock(&lock);
-                    return current->ptr;
-                }
-
-                Block* new_block = malloc(sizeof(Block));
-                if (!new_block) {
-                    current->free = 0;  // Use whole block without split
-                    pthread_mutex_unlock(&lock);
-                    return current->ptr;
-                }
-
-                total_used += sizeof(Block);
-
-                new_block->ptr = (char*)current->ptr + size;
-                new_block->size = leftover;
-                new_block->free = 1;
-                new_block->next = current->next;
-
-                current->size = size;
-                current->next = new_block;
+// Writes the trailer and marks the file clean once everything is on disk.
+static int pool_file_close_unlocked(void) {
+    size_t count = 0;
+    for (Block* current = block_list; current; current = current->next) {
+        count++;
+    }
+
+    int ok = 1;
+    uint64_t* records = malloc(count * sizeof(uint64_t) + 1);
+    if (records) {
+        size_t i = 0;
+        for (Block* current = block_list; current; current = current->next) {
+            records[i++] = (uint64_t)current->size << 1 | (current->free ? 1 : 0);
+        }
+        size_t bytes = count * sizeof(uint64_t);
+        off_t at = POOL_FILE_HEADER + (off_t)memory_pool_size;
+        ok = ftruncate(pool_fd, at + (off_t)bytes) == 0 &&
+             pwrite(pool_fd, records, bytes, at) == (ssize_t)bytes;
+        free(records);
+    } else {
+        ok = 0;
+    }
+
+    pool_header->block_count = count;
+    ok = ok && msync(pool_header, POOL_FILE_HEADER + memory_pool_size, MS_SYNC) == 0 &&
+         fsync(pool_fd) == 0;
+    if (ok) {
+        pool_header->clean = 1;
+        ok = msync(pool_header, POOL_FILE_HEADER, MS_SYNC) == 0;
+    } else {
+        fprintf(stderr, "Failed to write pool file; it stays marked unclean\n");
+    }
+
+    munmap(pool_header, POOL_FILE_HEADER + memory_pool_size);
+    close(pool_fd);
+    pool_header = NULL;
+    pool_fd = -1;
+    return ok;
+}
+
+static void remote_publish(RemoteBatch* batch) {
+    RemoteBatch* head = __atomic_load_n(&remote_batches, __ATOMIC_RELAXED);
+    do {
+        batch->next = head;
+    } while (!__atomic_compare_exchange_n(&remote_batches, &head, batch, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+// Frees every published batch of the current pool; the caller holds the lock.
+static void remote_drain_unlocked(void) {
+    if (!__atomic_load_n(&remote_batches, __ATOMIC_RELAXED)) return;
+
+    RemoteBatch* batch = __atomic_exchange_n(&remote_batches, NULL, __ATOMIC_ACQUIRE);
+    while (batch) {
+        RemoteBatch* next = batch->next;
+        if (batch->generation == mem_pool_generation) {
+            for (size_t i = 0; i < batch->count; i++) {
+                free_unlocked(batch->blocks[i]);
             }
+        }
+        free(batch);
+        batch = next;
+    }
+}
+
+// Takes the lock on an allocation path, applying queued remote frees first.
+static void lock_for_alloc(void) {
+    sync_lock(&lock);
+    remote_drain_unlocked();
+}
+
+// A thread that exits with a partial batch still hands it over.
+static void remote_thread_exit(void* batch) {
+    if (((RemoteBatch*)batch)->count > 0) remote_publish(batch);
+    else free(batch);
+}
 
-            current->free = 0;
-            pthread_mutex_unlock(&lock);
-            return current->ptr;
+static void remote_key_create(void) {
+    pthread_key_create(&remote_key, remote_thread_exit);
+}
+
+static void remote_set_local(RemoteBatch* batch) {
+    local_batch = batch;
+    pthread_setspecific(remote_key, batch);
+}
+
+void mem_free_remote(void* ptr) {
+    if (!ptr) return;
+
+    unsigned long generation = __atomic_load_n(&mem_pool_generation, __ATOMIC_ACQUIRE);
+    RemoteBatch* batch = local_batch;
+    if (!batch) {
+        batch = malloc(sizeof(RemoteBatch));
+        if (!batch) {
+            mem_free(ptr);
+            return;
         }
+        batch->count = 0;
+        batch->generation = generation;
+        pthread_once(&remote_key_once, remote_key_create);
+        remote_set_local(batch);
+    } else if (batch->generation != generation) {
+        // Started for a pool that is gone.
+        batch->count = 0;
+        batch->generation = generation;
+    }
 
-        current = current->next;
+    batch->blocks[batch->count++] = ptr;
+    if (batch->count == REMOTE_BATCH) {
+        remote_publish(batch);
+        remote_set_local(NULL);
     }
+}
 
-    pthread_mutex_unlock(&lock);
-    return NULL;
+void mem_flush_remote(void) {
+    RemoteBatch* batch = local_batch;
+    if (!batch || batch->count == 0) return;
+    remote_publish(batch);
+    remote_set_local(NULL);
+}
+
+void* mem_alloc(size_t size) {
+    lock_for_alloc();
+    void* ptr = alloc_unlocked(size);
+    sync_unlock(&lock);
+    return ptr;
 }
 
+// Clears the unmarked pages of [ptr, ptr + size), a block the caller owns.
+static void zero_unmarked(char* ptr, size_t size, const uint64_t* bitmap, uintptr_t first_page) {
+    if (!bitmap) {
+        memset(ptr, 0, size);
+        return;
+    }
+    char* end = ptr + size;
+    char* dirty = NULL;  // Start of the current run of unmarked pages
+    for (char* at = ptr; at < end; ) {
+        uintptr_t page = (uintptr_t)at >> page_shift;
+        char* next = (char*)((page + 1) << page_shift);
+        if (next > end) next = end;
+        size_t bit = page - first_page;
+        int zero = (__atomic_load_n(&bitmap[bit / 64], __ATOMIC_RELAXED) >> (bit % 64)) & 1;
+        if (!zero && !dirty) dirty = at;
+        if (zero && dirty) {
+            memset(dirty, 0, at - dirty);
+            dirty = NULL;
+        }
+        at = next;
+    }
+    if (dirty) memset(dirty, 0, end - dirty);
+}
+
+void* mem_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    size_t total = count * size;
+
+    lock_for_alloc();
+    void* ptr = alloc_unlocked(total);
+    const uint64_t* bitmap = zero_pages;
+    uintptr_t first_page = zero_first_page;
+    int pooled = in_pool(ptr);
+    sync_unlock(&lock);
+
+    // The block is ours now, so the memset runs without the lock. Large
+    // blocks are fresh anonymous mappings and need none.
+    if (ptr && total && pooled) zero_unmarked(ptr, total, bitmap, first_page);
+    return ptr;
+}
 
 void mem_free(void* ptr) {
     if (!ptr) return;
 
-    pthread_mutex_lock(&lock);
+    sync_lock(&lock);
+    if (in_pool(ptr)) {
+        free_unlocked(ptr);
+        sync_unlock(&lock);
+        return;
+    }
+    // Unmapping a large block can take a while; do it without the lock.
+    size_t length = large_remove_unlocked(ptr);
+    sync_unlock(&lock);
+    if (length) munmap(ptr, length);
+}
 
-    Block* current = block_list;
+void* mem_pool_base(void) {
+    return memory_pool;
+}
 
-    while (current) {
-        if (current->ptr == ptr) {
-            current->free = 1;
+size_t mem_pool_size(void) {
+    return memory_pool_size;
+}
 
-            Block* next = current->next;
-            if (next && next->free) {
-                current->size += sizeof(Block) + next->size;
-                current->next = next->next;
-                free(next);
-                total_used -= sizeof(Block);
-            }
+uint32_t mem_offset(const void* ptr) {
+    if (!ptr || !memory_pool) return MEM_NO_OFFSET;
+    uintptr_t offset = (uintptr_t)ptr - (uintptr_t)memory_pool;
+    if ((uintptr_t)ptr < (uintptr_t)memory_pool || offset >= memory_pool_size || offset >= MEM_NO_OFFSET) {
+        return MEM_NO_OFFSET;
+    }
+    return (uint32_t)offset;
+}
 
-            break;
-        }
+void* mem_at(uint32_t offset) {
+    if (offset == MEM_NO_OFFSET || !memory_pool || offset >= memory_pool_size) return NULL;
+    return (char*)memory_pool + offset;
+}
+
+void mem_set_root(uint32_t offset) {
+    sync_lock(&lock);
+    if (pool_header) pool_header->root = offset;
+    else heap_root = offset;
+    sync_unlock(&lock);
+}
+
+uint32_t mem_get_root(void) {
+    sync_lock(&lock);
+    uint32_t root = pool_header ? pool_header->root : heap_root;
+    sync_unlock(&lock);
+    return root;
+}
+
+void mem_lock(void) {
+    lock_for_alloc();
+}
+
+void mem_unlock(void) {
+    sync_unlock(&lock);
+}
+
+void* mem_alloc_unlocked(size_t size) {
+    return alloc_unlocked(size);
+}
+
+void* mem_alloc_near_unlocked(void* hint, size_t size) {
+    return alloc_near_unlocked(hint, size);
+}
+
+void mem_free_unlocked(void* ptr) {
+    if (ptr) free_unlocked(ptr);
+}
+
+void* mem_alloc_near(void* hint, size_t size) {
+    lock_for_alloc();
+    void* ptr = alloc_near_unlocked(hint, size);
+    sync_unlock(&lock);
+    return ptr;
+}
+
+size_t mem_alloc_batch(size_t size, void** blocks, size_t count) {
+    return mem_alloc_batch_near(NULL, size, blocks, count);
+}
+
+// Each block is placed after the previous one, so a batch taken from one
+// free extent is contiguous.
+size_t mem_alloc_batch_near(void* hint, size_t size, void** blocks, size_t count) {
+    if (size == 0) return 0;
+
+    lock_for_alloc();
+    size_t done = 0;
+    while (done < count && (blocks[done] = alloc_near_unlocked(hint, size))) {
+        hint = blocks[done];
+        done++;
+    }
+    sync_unlock(&lock);
+    return done;
+}
+
+size_t mem_alloc_run(void* hint, size_t size, void** blocks, size_t count) {
+    if (size == 0 || count == 0 || count > SIZE_MAX / size) return 0;
+
+    lock_for_alloc();
+
+    // Continuing right after hint saves the free list scan.
+    Block* owner = hint ? table_find(hint, NULL) : NULL;
+    Block* current = owner ? owner->next : NULL;
+    Block* largest = NULL;
+    if (!current || !current->free || current->size < size * count) {
+        int node = local_node();
+        current = maintenance_on ? bin_take(size * count, node) : NULL;
+        // With no filed block big enough, the last pass's largest stands in
+        // for the scan.
+        if (!current && maintenance_on && block_fits(largest_block, size)) largest = largest_block;
+        else if (!current) current = first_fit(size * count, node, &largest);
+    }
+    if (!current) {
+        current = largest;
+        if (current && current->size / size < count) count = current->size / size;
+    }
+
+    size_t done = 0;
+    while (current && done < count && take_block(current, size)) {
+        blocks[done++] = current->ptr;
         current = current->next;
     }
 
-    pthread_mutex_unlock(&lock);
+    sync_unlock(&lock);
+    return done;
+}
+
+void mem_free_batch(void** blocks, size_t count) {
+    sync_lock(&lock);
+    for (size_t i = 0; i < count; i++) {
+        if (blocks[i]) free_unlocked(blocks[i]);
+    }
+    sync_unlock(&lock);
+}
+
+/*
+ * Size-class caches (MEM_ALLOC_TYPED). Each thread keeps a stack of free
+ * blocks per class, linked through their first word; to the allocator
+ * they are still allocated. An empty stack is refilled with one run of
+ * MEM_CLASS_BATCH adjacent blocks and a full one gives half back, each
+ * under a single lock. A stack is stamped with the pool generation it was
+ * filled in and dropped without freeing once that pool is gone.
+ */
+__thread MemClassCache mem_class_caches[MEM_CLASSES] __attribute__((tls_model("initial-exec")));
+static pthread_key_t class_key;
+static pthread_once_t class_key_once = PTHREAD_ONCE_INIT;
+
+// A thread's cached blocks go back to the pool when it exits.
+static void class_thread_exit(void* caches) {
+    MemClassCache* cache = caches;
+    unsigned long generation = __atomic_load_n(&mem_pool_generation, __ATOMIC_ACQUIRE);
+    sync_lock(&lock);
+    for (unsigned cls = 0; cls < MEM_CLASSES; cls++) {
+        if (cache[cls].generation != generation) continue;
+        for (void* block = cache[cls].head; block; ) {
+            void* next = *(void**)block;
+            free_unlocked(block);
+            block = next;
+        }
+        cache[cls].head = NULL;
+        cache[cls].count = 0;
+    }
+    sync_unlock(&lock);
+}
+
+static void class_key_create(void) {
+    pthread_key_create(&class_key, class_thread_exit);
+}
+
+// Empties a cache left over from an earlier pool.
+static void class_cache_renew(MemClassCache* cache) {
+    unsigned long generation = __atomic_load_n(&mem_pool_generation, __ATOMIC_ACQUIRE);
+    if (cache->generation == generation) return;
+    cache->head = NULL;
+    cache->count = 0;
+    cache->generation = generation;
+}
+
+void* mem_class_refill(unsigned cls) {
+    MemClassCache* cache = &mem_class_caches[cls];
+    class_cache_renew(cache);
+    if (cache->head) return mem_class_alloc(cls);
+
+    void* blocks[MEM_CLASS_BATCH];
+    size_t got = mem_alloc_run(NULL, (cls + 1) * MEM_CLASS_GRANULE, blocks, MEM_CLASS_BATCH);
+    if (got == 0) return NULL;
+    for (size_t i = got - 1; i > 0; i--) {
+        *(void**)blocks[i] = cache->head;
+        cache->head = blocks[i];
+    }
+    cache->count = got - 1;
+    pthread_once(&class_key_once, class_key_create);
+    pthread_setspecific(class_key, mem_class_caches);
+    return blocks[0];
+}
+
+void mem_class_flush(unsigned cls, void* ptr) {
+    if (!ptr) return;
+    MemClassCache* cache = &mem_class_caches[cls];
+    class_cache_renew(cache);
+    if (cache->count >= MEM_CLASS_CACHE) {
+        void* blocks[MEM_CLASS_CACHE / 2];
+        for (size_t i = 0; i < MEM_CLASS_CACHE / 2; i++) {
+            blocks[i] = cache->head;
+            cache->head = *(void**)cache->head;
+        }
+        cache->count -= MEM_CLASS_CACHE / 2;
+        mem_free_batch(blocks, MEM_CLASS_CACHE / 2);
+    }
+    *(void**)ptr = cache->head;
+    cache->head = ptr;
+    cache->count++;
 }
 
 void* mem_resize(void* ptr, size_t size) {
     if (!ptr) return mem_alloc(size);
 
-    pthread_mutex_lock(&lock);
+    lock_for_alloc();
 
-    Block* current = block_list;
-    while (current) {
-        if (current->ptr == ptr) {
-            if (current->size >= size) {
-                pthread_mutex_unlock(&lock);
-                return ptr;
+    if (!in_pool(ptr)) {
+        LargeBlock* entry = large_find_unlocked(ptr);
+        size_t length = entry ? large_length(size) : 0;
+        void* moved = NULL;
+        if (entry && size <= entry->length) {
+            moved = ptr;
+            if (size > entry->size) entry->size = size;
+        } else if (length) {
+            // Held across mremap, so that nothing else is mapped at ptr
+            // before the entry is updated.
+            moved = mremap(ptr, entry->length, length, MREMAP_MAYMOVE);
+            if (moved == MAP_FAILED) {
+                moved = NULL;
             } else {
-                void* new_ptr = mem_alloc(size);
-                if (new_ptr) {
-                    memcpy(new_ptr, ptr, current->size);
-                    mem_free(ptr);
-                }
-                pthread_mutex_unlock(&lock);
-                return new_ptr;
+                *entry = (LargeBlock){ moved, size, length };
             }
         }
-        current = current->next;
+        sync_unlock(&lock);
+        return moved;
     }
 
-    pthread_mutex_unlock(&lock);
-    return NULL;
+    Block* current = table_find(ptr, NULL);
+    if (!current) {
+        sync_unlock(&lock);
+        return NULL;
+    }
+    if (current->size >= size) {
+        sync_unlock(&lock);
+        return ptr;
+    }
+
+    // Grow in place when the following block is free and large enough,
+    // unless the block is to become a large one.
+    Block* next = current->next;
+    if (next && next->free && current->size + next->size >= size && !large_wanted(size)
+        && same_segment(current, next)) {
+        size_t needed = size - current->size;
+        if (next->size > needed) {
+            next->ptr = (char*)next->ptr + needed;
+            next->size -= needed;
+            current->size = size;
+        } else {
+            free_list_remove(next);
+            block_merge_next(current);
+        }
+        sync_unlock(&lock);
+        return ptr;
+    }
+
+    size_t old_size = current->size;
+    void* new_ptr = alloc_unlocked(size);
+    if (new_ptr) {
+        memcpy(new_ptr, ptr, old_size);
+        free_unlocked(ptr);
+    }
+
+    sync_unlock(&lock);
+    return new_ptr;
 }
 
 void mem_deinit() {
-    pthread_mutex_lock(&lock);
+    // A queued page release must not run against a freed pool.
+    if (maintenance_executor) executor_wait(maintenance_executor, &maintenance);
+    sync_lock(&lock);
+    bins_clear();
+    // Blocks still queued belong to this pool; later ones are stale.
+    RemoteBatch* batch = __atomic_exchange_n(&remote_batches, NULL, __ATOMIC_ACQUIRE);
+    while (batch) {
+        RemoteBatch* next = batch->next;
+        free(batch);
+        batch = next;
+    }
+    __atomic_add_fetch(&mem_pool_generation, 1, __ATOMIC_RELEASE);
+
+    if (pool_fd >= 0) pool_file_close_unlocked();
+    else if (pool_mapped) munmap(memory_pool, memory_pool_size);
+    else free(memory_pool);
+    for (size_t i = 0; i < large_count; i++) {
+        munmap(large_blocks[i].ptr, large_blocks[i].length);
+    }
+    free(large_blocks);
+    large_blocks = NULL;
+    large_count = 0;
+    large_capacity = 0;
 
-    Block* current = block_list;
-    while (current) {
-        Block* next = current->next;
-        free(current);
-        current = next;
+    while (block_chunks) {
+        BlockChunk* next = block_chunks->next;
+        free(block_chunks);
+        block_chunks = next;
     }
+    free(table);
+    free(zero_pages);
 
-    free(memory_pool);
     memory_pool = NULL;
     block_list = NULL;
+    memset(free_lists, 0, sizeof(free_lists));
+    spare_blocks = NULL;
+    table = NULL;
+    zero_pages = NULL;
+    zero_page_words = 0;
+    table_capacity = 0;
+    table_count = 0;
     memory_pool_size = 0;
-    total_used = 0;
+    pool_mapped = 0;
+    segment_count = 1;
+    segment_node[0] = -1;
+    freed_since_release = 0;
+    released_bytes = 0;
+    lock.stats = (SyncLockStats){ 0 };
+
+    sync_unlock(&lock);
+}
+
+void mem_set_large_threshold(size_t bytes) {
+    sync_lock(&lock);
+    large_threshold = bytes;
+    sync_unlock(&lock);
+}
+
+void mem_set_release_threshold(size_t bytes) {
+    sync_lock(&lock);
+    release_threshold = bytes;
+    sync_unlock(&lock);
+}
+
+static void* maintenance_main(void* unused) {
+    (void)unused;
+    pthread_mutex_lock(&maintenance_lock);
+    while (!maintenance_stop) {
+        pthread_mutex_unlock(&maintenance_lock);
+        sync_lock(&lock);
+        if (memory_pool && maintenance_on) maintenance_tick_unlocked();
+        unsigned interval_us = maintenance_interval_us;
+        sync_unlock(&lock);
+
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += (long)interval_us * 1000;
+        until.tv_sec += until.tv_nsec / 1000000000;
+        until.tv_nsec %= 1000000000;
+        pthread_mutex_lock(&maintenance_lock);
+        if (!maintenance_stop) pthread_cond_timedwait(&maintenance_wake, &maintenance_lock, &until);
+    }
+    pthread_mutex_unlock(&maintenance_lock);
+    return NULL;
+}
+
+int mem_start_maintenance(unsigned interval_us) {
+    sync_lock(&lock);
+    maintenance_interval_us = interval_us;
+    if (maintenance_on) {
+        sync_unlock(&lock);
+        return 0;
+    }
+    maintenance_on = 1;
+    maintenance_stop = 0;
+    if (pthread_create(&maintenance_thread, NULL, maintenance_main, NULL) != 0) {
+        maintenance_on = 0;
+        sync_unlock(&lock);
+        return -1;
+    }
+    sync_unlock(&lock);
+    return 0;
+}
+
+void mem_stop_maintenance(void) {
+    sync_lock(&lock);
+    int running = maintenance_on;
+    maintenance_on = 0;
+    bins_clear();
+    sync_unlock(&lock);
+    if (!running) return;
+
+    pthread_mutex_lock(&maintenance_lock);
+    maintenance_stop = 1;
+    pthread_cond_signal(&maintenance_wake);
+    pthread_mutex_unlock(&maintenance_lock);
+    pthread_join(maintenance_thread, NULL);
+}
+
+size_t mem_release_free_pages(void) {
+    sync_lock(&lock);
+    size_t released = memory_pool ? release_free_pages_unlocked() : 0;
+    sync_unlock(&lock);
+    return released;
+}
+
+void mem_get_stats(MemStats* stats) {
+    sync_lock(&lock);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->pool_size = memory_pool_size;
+    stats->segments = segment_count;
+    for (int i = 0; i < segment_count; i++) {
+        stats->segment[i].node = segment_node[i];
+        stats->segment[i].size = memory_pool ? segment_end(i) - segment_start[i] : 0;
+    }
+    for (Block* current = block_list; current; current = current->next) {
+        MemNodeStats* segment = &stats->segment[segment_count > 1 ? segment_of(current->ptr) : 0];
+        if (current->free) {
+            stats->free_bytes += current->size;
+            stats->free_blocks++;
+            segment->free_bytes += current->size;
+            if (current->size > stats->largest_free) stats->largest_free = current->size;
+        } else {
+            stats->used_bytes += current->size;
+            stats->used_blocks++;
+            segment->used_bytes += current->size;
+        }
+    }
+    for (BlockChunk* chunk = block_chunks; chunk; chunk = chunk->next) {
+        stats->metadata_bytes += sizeof(BlockChunk);
+    }
+    stats->metadata_bytes += table_capacity * sizeof(Block*);
+    stats->metadata_bytes += zero_page_words * sizeof(uint64_t);
+    stats->released_bytes = released_bytes;
+    stats->lock = lock.stats;
+    stats->large_blocks = large_count;
+    for (size_t i = 0; i < large_count; i++) {
+        stats->large_bytes += large_blocks[i].length;
+    }
+    stats->metadata_bytes += large_capacity * sizeof(LargeBlock);
 
-    pthread_mutex_unlock(&lock);
-    pthread_mutex_destroy(&lock);
+    sync_unlock(&lock);
 }
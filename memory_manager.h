@@ -5,11 +5,200 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include "sync_lock.h"
+
+// Most segments mem_init_numa makes, and the highest node number it binds.
+#define MEM_MAX_NODES 8
+#define MEM_MAX_NODE_ID 63
+
+typedef struct MemNodeStats {
+    int node;           // Node the segment is bound to, -1 for none
+    size_t size;
+    size_t used_bytes;
+    size_t free_bytes;
+} MemNodeStats;
+
+typedef struct MemStats {
+    size_t pool_size;
+    size_t used_bytes;
+    size_t free_bytes;
+    size_t used_blocks;
+    size_t free_blocks;
+    size_t largest_free;    // Size of the largest free block
+    size_t metadata_bytes;  // Heap memory spent on block bookkeeping
+    size_t released_bytes;  // Free pages handed back since mem_init
+    size_t large_blocks;    // Blocks in mappings of their own
+    size_t large_bytes;     // Bytes mapped for them
+    SyncLockStats lock;     // Allocator lock use since mem_init
+    int segments;           // 1 unless the pool came from mem_init_numa
+    MemNodeStats segment[MEM_MAX_NODES];
+} MemStats;
 
 void mem_init(size_t size);
+// Places the pool in a shared mapping of path. A new file is sized for a
+// pool of size bytes; an existing one that was closed by mem_deinit is
+// reopened with its blocks and contents as they were (size is ignored).
+// Returns 0 for a new pool, 1 for a reopened one and -1 on failure,
+// including a file that was not shut down cleanly. mem_deinit writes
+// everything back and marks the file clean.
+int mem_init_file(const char* path, size_t size);
+// NUMA-aware pool: size bytes, rounded up to whole pages, split into
+// segments that are each bound to a node, one per online node when
+// segments is 0 or less (at most MEM_MAX_NODES). Allocations are served
+// from a segment on the calling thread's node while one has room, and no
+// block spans two segments. On a single-node machine nothing is bound and
+// it behaves like mem_init apart from the split. Returns the number of
+// segments, or -1 on failure; mem_deinit releases it like any pool.
+int mem_init_numa(size_t size, int segments);
 void* mem_alloc(size_t size);
 void mem_free(void* block);
 void* mem_resize(void* block, size_t size);
+// Allocates count * size zeroed bytes, or returns NULL if that overflows
+// or does not fit. Only pages that may have been written since the pool
+// was created or last released pages are cleared; the others are already
+// zero. File-backed pools are always cleared.
+void* mem_calloc(size_t count, size_t size);
 void mem_deinit();
+void mem_get_stats(MemStats* stats);
+
+// Background page release. Once bytes have been freed since the last pass,
+// a task on the shared executor (executor.h) gives the whole pages inside
+// large free blocks back to the kernel. Heap pool pages read as zero when
+// next used; file pool pages are read back from the file. 0, the default,
+// turns it off. mem_release_free_pages runs a pass now and returns the
+// bytes it released.
+void mem_set_release_threshold(size_t bytes);
+size_t mem_release_free_pages(void);
+
+// Large blocks. Once set, requests of at least bytes (including growth
+// through mem_resize) are served from a mapping of their own outside the
+// pool, which is unmapped when the block is freed; mem_resize grows them
+// with mremap instead of copying. They do not count against the pool
+// size, have no pool offset and are unmapped by mem_deinit. 0, the
+// default, keeps every block in the pool; file-backed pools always do.
+void mem_set_large_threshold(size_t bytes);
+
+// Background maintenance. A thread wakes every interval_us microseconds
+// and, for a bounded amount of work, files free blocks into size-class
+// bins and notes the largest free extent, so that allocations pick a
+// block from a bin instead of scanning the free list first fit. It can be
+// left running across mem_deinit and mem_init. mem_start_maintenance
+// returns 0, or -1 if the thread could not be started; calling it again
+// only changes the interval.
+int mem_start_maintenance(unsigned interval_us);
+void mem_stop_maintenance(void);
+
+// Cross-thread frees. mem_free_remote queues block without taking the
+// allocator lock: blocks are gathered in a per-thread batch, and full
+// batches are handed over lock-free and freed by the next allocation
+// (including mem_lock) in a single pass. mem_flush_remote hands over the
+// calling thread's partial batch; a thread's partial batch is also handed
+// over when it exits. Queued blocks count as used until they are applied,
+// and ones still queued at mem_deinit are discarded with the pool.
+void mem_free_remote(void* block);
+void mem_flush_remote(void);
+
+// Pool-relative addressing for structures that store 32-bit links instead
+// of pointers. Offsets are only meaningful between mem_init and mem_deinit;
+// MEM_NO_OFFSET stands for NULL and for pointers outside the pool.
+#define MEM_NO_OFFSET UINT32_MAX
+
+void* mem_pool_base(void);
+size_t mem_pool_size(void);
+uint32_t mem_offset(const void* ptr);
+void* mem_at(uint32_t offset);
+// One offset kept with the pool (in the file header for file-backed pools)
+// so a structure can be found again after reopening. Starts as MEM_NO_OFFSET.
+void mem_set_root(uint32_t offset);
+uint32_t mem_get_root(void);
+
+// Caller-synchronised path for layers that already serialise their own
+// operations: hold mem_lock() around any number of _unlocked calls instead
+// of paying for the allocator lock on each one.
+void mem_lock(void);
+void mem_unlock(void);
+void* mem_alloc_unlocked(size_t size);
+void* mem_alloc_near_unlocked(void* hint, size_t size);
+void mem_free_unlocked(void* block);
+
+// Placement hint: the block goes directly after hint's block when that
+// space is free, so neighbours in a structure are neighbours in memory.
+// Otherwise, or with a NULL hint, it behaves like mem_alloc.
+void* mem_alloc_near(void* hint, size_t size);
+
+// Allocate up to count blocks of size bytes under a single lock; returns
+// how many were stored in blocks. Each block is placed after the previous
+// one (the first after hint) when possible. mem_free_batch releases blocks
+// the same way.
+size_t mem_alloc_batch(size_t size, void** blocks, size_t count);
+size_t mem_alloc_batch_near(void* hint, size_t size, void** blocks, size_t count);
+void mem_free_batch(void** blocks, size_t count);
+
+// Carves up to count adjacent blocks of size bytes out of one free extent:
+// the one right after hint's block if it fits them all, else the first on
+// the free list that does, else the largest. Returns how many. While
+// maintenance runs, the bins and the largest extent of its last pass stand
+// in for the free list scan, so a run may come back shorter.
+size_t mem_alloc_run(void* hint, size_t size, void** blocks, size_t count);
+
+
+// Size-class fast path for small fixed-size objects. MEM_ALLOC_TYPED(T)
+// rounds sizeof(T) up to a class at compile time and pops a block from
+// the calling thread's free stack for that class, taking the allocator
+// lock only to refill the stack MEM_CLASS_BATCH blocks at a time. Blocks
+// must go back with MEM_FREE_TYPED of a type of the same class (or with
+// mem_free), and a class block may be up to MEM_CLASS_GRANULE - 1 bytes
+// larger than the type. Cached blocks count as used in MemStats; a
+// thread's cache returns to the pool when the thread exits, and caches
+// are dropped with their pool at mem_deinit. Types larger than
+// MEM_CLASS_MAX do not compile.
+#define MEM_CLASS_GRANULE 16
+#define MEM_CLASSES 8
+#define MEM_CLASS_MAX (MEM_CLASS_GRANULE * MEM_CLASSES)
+#define MEM_CLASS_BATCH 32
+#define MEM_CLASS_CACHE 64  // Blocks a stack holds before giving half back
+
+#define MEM_CLASS_OF(size) (((size) + MEM_CLASS_GRANULE - 1) / MEM_CLASS_GRANULE - 1)
+#define MEM_TYPE_CLASS(type) \
+    (MEM_CLASS_OF(sizeof(type)) + 0 * sizeof(char[sizeof(type) <= MEM_CLASS_MAX ? 1 : -1]))
+#define MEM_ALLOC_TYPED(type) ((type*)mem_class_alloc(MEM_TYPE_CLASS(type)))
+#define MEM_FREE_TYPED(type, block) mem_class_free(MEM_TYPE_CLASS(type), (block))
+
+typedef struct MemClassCache {
+    void* head;
+    size_t count;
+    unsigned long generation;  // mem_pool_generation when filled
+} MemClassCache;
+
+extern __thread MemClassCache mem_class_caches[MEM_CLASSES];
+extern unsigned long mem_pool_generation;
+
+// Slow paths of the two below.
+void* mem_class_refill(unsigned cls);
+void mem_class_flush(unsigned cls, void* block);
+
+static inline void* mem_class_alloc(unsigned cls) {
+    MemClassCache* cache = &mem_class_caches[cls];
+    void* block = cache->head;
+    if (block && cache->generation == __atomic_load_n(&mem_pool_generation, __ATOMIC_RELAXED)) {
+        cache->head = *(void**)block;
+        cache->count--;
+        return block;
+    }
+    return mem_class_refill(cls);
+}
+
+static inline void mem_class_free(unsigned cls, void* block) {
+    MemClassCache* cache = &mem_class_caches[cls];
+    if (block && cache->count < MEM_CLASS_CACHE
+        && cache->generation == __atomic_load_n(&mem_pool_generation, __ATOMIC_RELAXED)) {
+        *(void**)block = cache->head;
+        cache->head = block;
+        cache->count++;
+        return;
+    }
+    mem_class_flush(cls, block);
+}
 
 #endif
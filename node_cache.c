@@ -0,0 +1,61 @@
+#include "memory_manager.h"
+#include "node_cache.h"
+
+static void * link_get(void * node) {
+    return *(void **)node;
+}
+
+static void link_set(void * node, void * next) {
+    *(void **)node = next;
+}
+
+void node_cache_init(NodeCache * cache, size_t node_size) {
+    cache->spare = NULL;
+    cache->count = 0;
+    cache->node_size = node_size;
+}
+
+void * node_cache_get(NodeCache * cache, void * hint) {
+    if (!cache->spare) {
+        void * batch[NODE_CACHE_BATCH];
+        size_t got = mem_alloc_batch_near(hint, cache->node_size, batch, NODE_CACHE_BATCH);
+        for (size_t i = got; i > 0; i--) {
+            link_set(batch[i - 1], cache->spare);
+            cache->spare = batch[i - 1];
+        }
+        cache->count = got;
+    }
+
+    void * node = cache->spare;
+    if (node) {
+        cache->spare = link_get(node);
+        cache->count--;
+    }
+    return node;
+}
+
+// Hands stashed nodes back to the pool, keeping at most keep of them.
+static void cache_trim(NodeCache * cache, size_t keep) {
+    void * batch[NODE_CACHE_BATCH];
+    while (cache->count > keep) {
+        size_t n = 0;
+        while (n < NODE_CACHE_BATCH && cache->count > keep) {
+            batch[n++] = cache->spare;
+            cache->spare = link_get(cache->spare);
+            cache->count--;
+        }
+        mem_free_batch(batch, n);
+    }
+}
+
+void node_cache_put(NodeCache * cache, void * node) {
+    link_set(node, cache->spare);
+    cache->spare = node;
+    if (++cache->count > 2 * NODE_CACHE_BATCH) {
+        cache_trim(cache, NODE_CACHE_BATCH);
+    }
+}
+
+void node_cache_drain(NodeCache * cache) {
+    cache_trim(cache, 0);
+}
@@ -0,0 +1,30 @@
+#ifndef NODE_CACHE_H
+#define NODE_CACHE_H
+
+#include <stddef.h>
+
+// Nodes taken from or returned to the pool at a time.
+#define NODE_CACHE_BATCH 32
+
+// Per-list stash of free nodes of one size, so that a list operation only
+// needs the list's own lock. It is refilled from the memory manager
+// NODE_CACHE_BATCH nodes at a time and gives nodes back once it holds
+// twice that many, so a list may keep up to 2 * NODE_CACHE_BATCH nodes of
+// the pool in reserve until node_cache_drain. The caller synchronises
+// access; a free node's first pointer-sized bytes hold the stash link.
+typedef struct NodeCache {
+    void * spare;
+    size_t count;
+    size_t node_size;
+} NodeCache;
+
+void node_cache_init(NodeCache * cache, size_t node_size);
+// Returns a node from the stash or the pool, or NULL if both are empty.
+// When the stash is refilled, the new batch is placed after hint if the
+// pool has room there (see mem_alloc_batch_near).
+void * node_cache_get(NodeCache * cache, void * hint);
+void node_cache_put(NodeCache * cache, void * node);
+// Hands every stashed node back to the pool.
+void node_cache_drain(NodeCache * cache);
+
+#endif // NODE_CACHE_H
@@ -0,0 +1,233 @@
+#include "memory_manager.h"
+#include "offset_list.h"
+#include "list_render.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+// Kept in the pool and registered as its root by olist_persist.
+typedef struct OListRoot {
+    uint32_t head;
+    uint32_t tail;
+    uint64_t count;
+} OListRoot;
+
+// The base is cached in the list so that following a link is one add.
+static inline ONode * at(OList * list, uint32_t offset) {
+    return offset == MEM_NO_OFFSET ? NULL : (ONode *)(list->base + offset);
+}
+
+static inline uint32_t offset_of(OList * list, ONode * node) {
+    return node ? (uint32_t)((char *)node - list->base) : MEM_NO_OFFSET;
+}
+
+static ONode * onode_new(OList * list, uint16_t data, ONode * hint) {
+    ONode * node = node_cache_get(&list->cache, hint);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return NULL;
+    }
+    node->data = data;
+    node->next = MEM_NO_OFFSET;
+    return node;
+}
+
+int olist_create(OList * list) {
+    list->base = mem_pool_base();
+    list->head = MEM_NO_OFFSET;
+    list->tail = MEM_NO_OFFSET;
+    list->count = 0;
+    list->root = MEM_NO_OFFSET;
+    node_cache_init(&list->cache, sizeof(ONode));
+    sync_lock_init(&list->lock);
+
+    if (!list->base || mem_pool_size() >= MEM_NO_OFFSET) {
+        printf("Pool missing or too large for 32-bit offsets.\n");
+        return 0;
+    }
+    return 1;
+}
+
+void olist_destroy(OList * list) {
+    sync_lock(&list->lock);
+
+    ONode * current = at(list, list->head);
+    while (current) {
+        ONode * next = at(list, current->next);
+        node_cache_put(&list->cache, current);
+        current = next;
+    }
+    node_cache_drain(&list->cache);
+    if (list->root != MEM_NO_OFFSET) {
+        mem_free(at(list, list->root));
+        if (mem_get_root() == list->root) mem_set_root(MEM_NO_OFFSET);
+        list->root = MEM_NO_OFFSET;
+    }
+    list->head = MEM_NO_OFFSET;
+    list->tail = MEM_NO_OFFSET;
+    list->count = 0;
+
+    sync_unlock(&list->lock);
+    sync_lock_destroy(&list->lock);
+}
+
+void olist_append(OList * list, uint16_t data) {
+    sync_lock(&list->lock);
+
+    ONode * tail = at(list, list->tail);
+    ONode * node = onode_new(list, data, tail);
+    if (node) {
+        uint32_t offset = offset_of(list, node);
+        if (tail) tail->next = offset;
+        else list->head = offset;
+        list->tail = offset;
+        list->count++;
+    }
+
+    sync_unlock(&list->lock);
+}
+
+void olist_prepend(OList * list, uint16_t data) {
+    sync_lock(&list->lock);
+
+    ONode * node = onode_new(list, data, at(list, list->head));
+    if (node) {
+        node->next = list->head;
+        list->head = offset_of(list, node);
+        if (list->tail == MEM_NO_OFFSET) list->tail = list->head;
+        list->count++;
+    }
+
+    sync_unlock(&list->lock);
+}
+
+void olist_insert_after(OList * list, ONode * node, uint16_t data) {
+    if (!node) {
+        printf("Cannot insert after a NULL node.\n");
+        return;
+    }
+
+    sync_lock(&list->lock);
+
+    ONode * new_node = onode_new(list, data, node);
+    if (new_node) {
+        new_node->next = node->next;
+        node->next = offset_of(list, new_node);
+        if (at(list, list->tail) == node) list->tail = node->next;
+        list->count++;
+    }
+
+    sync_unlock(&list->lock);
+}
+
+void olist_remove(OList * list, uint16_t data) {
+    sync_lock(&list->lock);
+
+    ONode * previous = NULL;
+    ONode * current = at(list, list->head);
+    while (current && current->data != data) {
+        previous = current;
+        current = at(list, current->next);
+    }
+
+    if (current) {
+        if (previous) previous->next = current->next;
+        else list->head = current->next;
+        if (at(list, list->tail) == current) list->tail = offset_of(list, previous);
+        list->count--;
+        node_cache_put(&list->cache, current);
+    }
+
+    sync_unlock(&list->lock);
+}
+
+ONode * olist_find(OList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    ONode * current = at(list, list->head);
+    while (current && current->data != data) {
+        current = at(list, current->next);
+    }
+    sync_unlock(&list->lock);
+    return current;
+}
+
+ONode * olist_head(OList * list) {
+    return at(list, list->head);
+}
+
+ONode * olist_next(OList * list, ONode * node) {
+    return at(list, node->next);
+}
+
+size_t olist_count_nodes(OList * list) {
+    sync_lock(&list->lock);
+    size_t count = 0;
+    for (ONode * current = at(list, list->head); current; current = at(list, current->next)) {
+        count++;
+    }
+    sync_unlock(&list->lock);
+    return count;
+}
+
+size_t olist_length(OList * list) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    sync_unlock(&list->lock);
+    return count;
+}
+
+void olist_print(OList * list) {
+    RenderBuf * buf = render_pool_get();
+
+    sync_lock(&list->lock);
+    render_bytes(buf, "[", 1);
+    bool first = true;
+    for (ONode * current = at(list, list->head); current; current = at(list, current->next)) {
+        render_item(buf, current->data, first);
+        first = false;
+    }
+    render_bytes(buf, "]\n", 2);
+    sync_unlock(&list->lock);
+
+    if (render_emit(buf, stdout, -1) < 0) {
+        printf("Failed to display list.\n");
+    }
+}
+
+int olist_persist(OList * list) {
+    sync_lock(&list->lock);
+
+    node_cache_drain(&list->cache);
+    if (list->root == MEM_NO_OFFSET) {
+        OListRoot * root = mem_alloc(sizeof(OListRoot));
+        if (!root) {
+            printf("Failed to allocate list root.\n");
+            sync_unlock(&list->lock);
+            return 0;
+        }
+        list->root = offset_of(list, (ONode *)root);
+        mem_set_root(list->root);
+    }
+    OListRoot * root = (OListRoot *)at(list, list->root);
+    root->head = list->head;
+    root->tail = list->tail;
+    root->count = list->count;
+
+    sync_unlock(&list->lock);
+    return 1;
+}
+
+int olist_restore(OList * list) {
+    if (!olist_create(list)) return 0;
+
+    uint32_t offset = mem_get_root();
+    if (offset == MEM_NO_OFFSET) {
+        printf("Pool has no saved list.\n");
+        return 0;
+    }
+    OListRoot * root = (OListRoot *)at(list, offset);
+    list->root = offset;
+    list->head = root->head;
+    list->tail = root->tail;
+    list->count = root->count;
+    return 1;
+}
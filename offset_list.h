@@ -0,0 +1,55 @@
+#ifndef OFFSET_LIST_H
+#define OFFSET_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "sync_lock.h"
+#include "node_cache.h"
+
+// Compact list whose links are 32-bit byte offsets from the memory pool
+// base (see mem_offset) instead of pointers, so a node takes 8 bytes
+// rather than 16 and a cache line holds twice as many. The pool must be
+// initialised before olist_create and be smaller than 4 GiB; the list must
+// be destroyed before mem_deinit. Each OList has its own lock.
+typedef struct ONode {
+    uint32_t next;   // MEM_NO_OFFSET at the tail
+    uint16_t data;
+} ONode;
+
+typedef struct OList {
+    char * base;     // Pool base the offsets are relative to
+    uint32_t head;
+    uint32_t tail;
+    size_t count;
+    uint32_t root;   // Saved ends in the pool, once persisted or restored
+    NodeCache cache;
+    SyncLock lock;
+} OList;
+
+// Returns 0 if there is no pool or it is too large for 32-bit offsets.
+int olist_create(OList * list);
+void olist_destroy(OList * list);
+void olist_append(OList * list, uint16_t data);
+void olist_prepend(OList * list, uint16_t data);
+void olist_insert_after(OList * list, ONode * node, uint16_t data);
+void olist_remove(OList * list, uint16_t data);
+ONode * olist_find(OList * list, uint16_t data);
+ONode * olist_head(OList * list);
+// Following node, or NULL at the tail.
+ONode * olist_next(OList * list, ONode * node);
+size_t olist_count_nodes(OList * list);
+size_t olist_length(OList * list);
+void olist_print(OList * list);
+
+// With a file-backed pool (mem_init_file) the list survives a restart:
+// olist_persist records its ends in a pool block registered as the pool
+// root, and after the file is reopened olist_restore sets the list up from
+// that root without touching its nodes. Call olist_persist before
+// mem_deinit; it also hands spare nodes back so none leak into the file.
+// olist_destroy releases the saved root along with the nodes.
+// Both return 1 on success and 0 on failure.
+int olist_persist(OList * list);
+int olist_restore(OList * list);
+
+#endif // OFFSET_LIST_H
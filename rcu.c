@@ -0,0 +1,157 @@
+#include "rcu.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+
+// Retired objects are released in batches once this many are pending.
+#define RECLAIM_BATCH 64
+
+typedef struct ReaderRecord {
+    uint64_t epoch;      // 0 while outside a read section
+    int nesting;
+    int in_use;
+    struct ReaderRecord * next;
+} ReaderRecord;
+
+typedef struct Retired {
+    void * ptr;
+    void (*release)(void *);
+    uint64_t epoch;
+} Retired;
+
+static uint64_t global_epoch = 1;
+
+// Records are never freed; a thread that exits hands its record on.
+static ReaderRecord * readers = NULL;
+static pthread_mutex_t readers_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t reader_key;
+static pthread_once_t reader_key_once = PTHREAD_ONCE_INIT;
+static __thread ReaderRecord * my_record = NULL;
+
+static Retired * retired = NULL;
+static size_t retired_count = 0;
+static size_t retired_capacity = 0;
+static pthread_mutex_t retired_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void record_release(void * arg) {
+    ReaderRecord * record = arg;
+    __atomic_store_n(&record->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&record->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void reader_key_init(void) {
+    pthread_key_create(&reader_key, record_release);
+}
+
+static ReaderRecord * record_get(void) {
+    if (my_record) return my_record;
+
+    pthread_once(&reader_key_once, reader_key_init);
+    pthread_mutex_lock(&readers_lock);
+
+    ReaderRecord * record = readers;
+    while (record && __atomic_load_n(&record->in_use, __ATOMIC_ACQUIRE)) {
+        record = record->next;
+    }
+    if (!record) {
+        record = calloc(1, sizeof(ReaderRecord));
+        if (!record) {
+            fprintf(stderr, "Failed to allocate RCU reader record\n");
+            abort();
+        }
+        record->next = readers;
+        __atomic_store_n(&readers, record, __ATOMIC_RELEASE);
+    }
+    record->in_use = 1;
+    record->nesting = 0;
+
+    pthread_mutex_unlock(&readers_lock);
+    pthread_setspecific(reader_key, record);
+    my_record = record;
+    return record;
+}
+
+void rcu_read_lock(void) {
+    ReaderRecord * record = record_get();
+    if (record->nesting++ > 0) return;
+
+    uint64_t epoch = __atomic_load_n(&global_epoch, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&record->epoch, epoch, __ATOMIC_RELAXED);
+    // The announcement must be visible before any shared pointer is read.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void rcu_read_unlock(void) {
+    ReaderRecord * record = my_record;
+    if (--record->nesting > 0) return;
+    __atomic_store_n(&record->epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Smallest epoch announced by an active reader, or UINT64_MAX if none.
+static uint64_t oldest_reader(void) {
+    uint64_t oldest = UINT64_MAX;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (ReaderRecord * record = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); record; record = record->next) {
+        uint64_t epoch = __atomic_load_n(&record->epoch, __ATOMIC_ACQUIRE);
+        if (epoch && epoch < oldest) oldest = epoch;
+    }
+    return oldest;
+}
+
+// Releases every object retired before the given epoch. Entries are
+// appended in epoch order, so the releasable ones form a prefix.
+static void reclaim_before(uint64_t epoch) {
+    size_t done = 0;
+    while (done < retired_count && retired[done].epoch < epoch) {
+        retired[done].release(retired[done].ptr);
+        done++;
+    }
+    memmove(retired, retired + done, (retired_count - done) * sizeof(Retired));
+    retired_count -= done;
+}
+
+void rcu_retire(void * ptr, void (*release)(void *)) {
+    pthread_mutex_lock(&retired_lock);
+
+    if (retired_count == retired_capacity) {
+        size_t capacity = retired_capacity ? retired_capacity * 2 : RECLAIM_BATCH * 2;
+        Retired * grown = realloc(retired, capacity * sizeof(Retired));
+        if (!grown) {
+            // Out of memory: fall back to waiting for the grace period now.
+            pthread_mutex_unlock(&retired_lock);
+            rcu_synchronize();
+            release(ptr);
+            return;
+        }
+        retired = grown;
+        retired_capacity = capacity;
+    }
+
+    // Readers that announced this epoch may still hold ptr; bumping the
+    // epoch marks everyone arriving later as safe.
+    uint64_t epoch = __atomic_fetch_add(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    retired[retired_count].ptr = ptr;
+    retired[retired_count].release = release;
+    retired[retired_count].epoch = epoch;
+    retired_count++;
+
+    if (retired_count >= RECLAIM_BATCH) {
+        reclaim_before(oldest_reader());
+    }
+
+    pthread_mutex_unlock(&retired_lock);
+}
+
+void rcu_synchronize(void) {
+    uint64_t target = __atomic_fetch_add(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    while (oldest_reader() <= target) {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&retired_lock);
+    reclaim_before(target + 1);
+    pthread_mutex_unlock(&retired_lock);
+}
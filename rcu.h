@@ -0,0 +1,21 @@
+#ifndef RCU_H
+#define RCU_H
+
+// Minimal epoch-based read-copy-update support.
+//
+// Readers bracket their traversal with rcu_read_lock/rcu_read_unlock, which
+// only publish the current epoch in a per-thread record and never block.
+// Writers unlink an object, then hand it to rcu_retire; it is released once
+// every reader that might still see it has left its critical section.
+// Read sections may nest. A thread must not call rcu_synchronize from
+// inside a read section.
+
+void rcu_read_lock(void);
+void rcu_read_unlock(void);
+
+// Defers release(ptr) until a grace period has passed.
+void rcu_retire(void * ptr, void (*release)(void *));
+// Waits for all current readers, then releases everything retired so far.
+void rcu_synchronize(void);
+
+#endif // RCU_H
@@ -0,0 +1,135 @@
+#include "memory_manager.h"
+#include "rcu_list.h"
+#include "rcu.h"
+#include <stdio.h>
+
+static RNode * rnode_new(uint16_t data) {
+    RNode * node = (RNode *)mem_alloc(sizeof(RNode));
+    if (!node) {
+        // The pool may only be full of retired nodes waiting for readers.
+        rcu_synchronize();
+        node = (RNode *)mem_alloc(sizeof(RNode));
+        if (!node) return NULL;
+    }
+    node->data = data;
+    node->next = NULL;
+    return node;
+}
+
+static void rnode_release(void * node) {
+    mem_free(node);
+}
+
+void rlist_init(RList * list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    pthread_mutex_init(&list->writer_lock, NULL);
+}
+
+void rlist_insert(RList * list, uint16_t data) {
+    RNode * node = rnode_new(data);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return;
+    }
+
+    pthread_mutex_lock(&list->writer_lock);
+    if (list->tail) __atomic_store_n(&list->tail->next, node, __ATOMIC_RELEASE);
+    else __atomic_store_n(&list->head, node, __ATOMIC_RELEASE);
+    list->tail = node;
+    __atomic_add_fetch(&list->count, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&list->writer_lock);
+}
+
+void rlist_push_front(RList * list, uint16_t data) {
+    RNode * node = rnode_new(data);
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        return;
+    }
+
+    pthread_mutex_lock(&list->writer_lock);
+    node->next = list->head;
+    __atomic_store_n(&list->head, node, __ATOMIC_RELEASE);
+    if (!list->tail) list->tail = node;
+    __atomic_add_fetch(&list->count, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&list->writer_lock);
+}
+
+bool rlist_delete(RList * list, uint16_t data) {
+    pthread_mutex_lock(&list->writer_lock);
+
+    RNode * previous = NULL;
+    RNode * current = list->head;
+    while (current && current->data != data) {
+        previous = current;
+        current = current->next;
+    }
+
+    if (!current) {
+        pthread_mutex_unlock(&list->writer_lock);
+        return false;
+    }
+
+    // Readers already on current keep following its (unchanged) next link.
+    if (previous) __atomic_store_n(&previous->next, current->next, __ATOMIC_RELEASE);
+    else __atomic_store_n(&list->head, current->next, __ATOMIC_RELEASE);
+    if (list->tail == current) list->tail = previous;
+    __atomic_sub_fetch(&list->count, 1, __ATOMIC_RELAXED);
+
+    pthread_mutex_unlock(&list->writer_lock);
+
+    rcu_retire(current, rnode_release);
+    return true;
+}
+
+RNode * rlist_search(RList * list, uint16_t data) {
+    RNode * current = __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+    while (current) {
+        if (current->data == data) return current;
+        current = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+    }
+    return NULL;
+}
+
+bool rlist_contains(RList * list, uint16_t data) {
+    rcu_read_lock();
+    bool found = rlist_search(list, data) != NULL;
+    rcu_read_unlock();
+    return found;
+}
+
+void rlist_display(RList * list) {
+    rcu_read_lock();
+
+    printf("[");
+    RNode * current = __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+    while (current) {
+        printf("%d", current->data);
+        current = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+        if (current) printf(", ");
+    }
+    printf("]\n");
+
+    rcu_read_unlock();
+}
+
+size_t rlist_count_nodes(RList * list) {
+    return __atomic_load_n(&list->count, __ATOMIC_RELAXED);
+}
+
+void rlist_cleanup(RList * list) {
+    rcu_synchronize();
+
+    RNode * current = list->head;
+    while (current) {
+        RNode * next = current->next;
+        mem_free(current);
+        current = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    pthread_mutex_destroy(&list->writer_lock);
+}
@@ -0,0 +1,39 @@
+#ifndef RCU_LIST_H
+#define RCU_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Read-mostly list. Searching, counting and displaying take no lock: they
+// run inside an RCU read section (see rcu.h) and follow links published
+// with atomic stores. Writers serialise on writer_lock, link fully built
+// nodes in with a single pointer store and defer mem_free of unlinked
+// nodes until every reader that could still see them has finished.
+typedef struct RNode {
+    uint16_t data;
+    struct RNode * next;
+} RNode;
+
+typedef struct RList {
+    RNode * head;
+    RNode * tail;         // Only used by writers
+    size_t count;
+    pthread_mutex_t writer_lock;
+} RList;
+
+void rlist_init(RList * list);
+void rlist_insert(RList * list, uint16_t data);
+void rlist_push_front(RList * list, uint16_t data);
+bool rlist_delete(RList * list, uint16_t data);
+bool rlist_contains(RList * list, uint16_t data);
+// Must be called inside rcu_read_lock/rcu_read_unlock; the result stays
+// valid until the caller leaves that read section.
+RNode * rlist_search(RList * list, uint16_t data);
+void rlist_display(RList * list);
+size_t rlist_count_nodes(RList * list);
+// Waits for readers to finish; no other thread may use the list afterwards.
+void rlist_cleanup(RList * list);
+
+#endif // RCU_LIST_H
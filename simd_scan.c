@@ -0,0 +1,192 @@
+#include "simd_scan.h"
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+typedef long (*find_fn)(const uint16_t *, size_t, uint16_t);
+typedef size_t (*count_fn)(const uint16_t *, size_t, uint16_t);
+
+static long find_scalar(const uint16_t * values, size_t n, uint16_t key) {
+    for (size_t i = 0; i < n; i++) {
+        if (values[i] == key) return (long)i;
+    }
+    return -1;
+}
+
+static size_t count_scalar(const uint16_t * values, size_t n, uint16_t key) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        count += values[i] == key;
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+
+// movemask yields two bits per 16-bit lane, hence the halving below.
+
+__attribute__((target("sse2")))
+static long find_sse2(const uint16_t * values, size_t n, uint16_t key) {
+    __m128i k = _mm_set1_epi16((short)key);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(values + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(values + i + 8));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(a, k))
+                      | (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(b, k)) << 16;
+        if (mask) return (long)(i + (__builtin_ctz(mask) >> 1));
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(values + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(a, k));
+        if (mask) return (long)(i + (__builtin_ctz(mask) >> 1));
+    }
+
+    long tail = find_scalar(values + i, n - i, key);
+    return tail < 0 ? -1 : (long)i + tail;
+}
+
+__attribute__((target("sse2")))
+static size_t count_sse2(const uint16_t * values, size_t n, uint16_t key) {
+    __m128i k = _mm_set1_epi16((short)key);
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(values + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(values + i + 8));
+        __m128i hits = _mm_packs_epi16(_mm_cmpeq_epi16(a, k), _mm_cmpeq_epi16(b, k));
+        count += __builtin_popcount((unsigned)_mm_movemask_epi8(hits));
+    }
+    return count + count_scalar(values + i, n - i, key);
+}
+
+// The AVX2 kernels finish short tails with 128-bit ops compiled for the same
+// target rather than calling the SSE2 kernels: mixing legacy SSE and VEX
+// code costs a state transition per call, which dominates 27-value nodes.
+
+__attribute__((target("avx2")))
+static long find_avx2(const uint16_t * values, size_t n, uint16_t key) {
+    __m256i k = _mm256_set1_epi16((short)key);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(values + i + 16));
+        unsigned long long mask =
+            (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, k))
+            | (unsigned long long)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(b, k)) << 32;
+        if (mask) return (long)(i + (__builtin_ctzll(mask) >> 1));
+    }
+    if (i + 16 <= n) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(values + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, k));
+        if (mask) return (long)(i + (__builtin_ctz(mask) >> 1));
+        i += 16;
+    }
+    if (i + 8 <= n) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(values + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(a, _mm256_castsi256_si128(k)));
+        if (mask) return (long)(i + (__builtin_ctz(mask) >> 1));
+        i += 8;
+    }
+    for (; i < n; i++) {
+        if (values[i] == key) return (long)i;
+    }
+    return -1;
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t count_avx2(const uint16_t * values, size_t n, uint16_t key) {
+    __m256i k = _mm256_set1_epi16((short)key);
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(values + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(values + i + 16));
+        // packs interleaves 128-bit lanes, which does not matter for a count.
+        __m256i hits = _mm256_packs_epi16(_mm256_cmpeq_epi16(a, k), _mm256_cmpeq_epi16(b, k));
+        count += __builtin_popcount((unsigned)_mm256_movemask_epi8(hits));
+    }
+    if (i + 16 <= n) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(values + i));
+        count += __builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, k))) >> 1;
+        i += 16;
+    }
+    for (; i < n; i++) {
+        count += values[i] == key;
+    }
+    return count;
+}
+
+#endif // HAVE_X86_SIMD
+
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+static SimdLevel level = SIMD_SCALAR;
+static find_fn find_impl = find_scalar;
+static count_fn count_impl = count_scalar;
+
+// The level may change while other threads scan, so the pointers are
+// stored and loaded atomically; a scan racing with a change may pair the
+// old find with the new count, and every kernel gives the same answers.
+static void apply_level(SimdLevel wanted) {
+    find_fn find = find_scalar;
+    count_fn count = count_scalar;
+    switch (wanted) {
+#ifdef HAVE_X86_SIMD
+    case SIMD_AVX2:
+        find = find_avx2;
+        count = count_avx2;
+        break;
+    case SIMD_SSE2:
+        find = find_sse2;
+        count = count_sse2;
+        break;
+#endif
+    default:
+        wanted = SIMD_SCALAR;
+        break;
+    }
+    __atomic_store_n(&find_impl, find, __ATOMIC_RELAXED);
+    __atomic_store_n(&count_impl, count, __ATOMIC_RELAXED);
+    __atomic_store_n(&level, wanted, __ATOMIC_RELAXED);
+}
+
+static void dispatch_init(void) {
+    apply_level(simd_detect());
+}
+
+SimdLevel simd_detect(void) {
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+SimdLevel simd_get_level(void) {
+    pthread_once(&dispatch_once, dispatch_init);
+    return __atomic_load_n(&level, __ATOMIC_RELAXED);
+}
+
+void simd_set_level(SimdLevel wanted) {
+    pthread_once(&dispatch_once, dispatch_init);
+    SimdLevel best = simd_detect();
+    apply_level(wanted > best ? best : wanted);
+}
+
+long u16_find(const uint16_t * values, size_t n, uint16_t key) {
+    pthread_once(&dispatch_once, dispatch_init);
+    return __atomic_load_n(&find_impl, __ATOMIC_RELAXED)(values, n, key);
+}
+
+size_t u16_count(const uint16_t * values, size_t n, uint16_t key) {
+    pthread_once(&dispatch_once, dispatch_init);
+    return __atomic_load_n(&count_impl, __ATOMIC_RELAXED)(values, n, key);
+}
@@ -0,0 +1,26 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Instruction sets the scan kernels can use, in increasing order.
+typedef enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2,
+    SIMD_AVX2
+} SimdLevel;
+
+// Best level supported by the CPU and this build.
+SimdLevel simd_detect(void);
+SimdLevel simd_get_level(void);
+// Selects the kernels to use; levels above simd_detect() are clamped. It may
+// be called while other threads are scanning.
+void simd_set_level(SimdLevel level);
+
+// Index of the first value equal to key, or -1.
+long u16_find(const uint16_t * values, size_t n, uint16_t key);
+// Number of values equal to key.
+size_t u16_count(const uint16_t * values, size_t n, uint16_t key);
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,181 @@
+#include "memory_manager.h"
+#include "sorted_list.h"
+#include "list_render.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+// One level up with probability 1/4.
+static int random_level(SList * list) {
+    // xorshift32; the lock is held, so the per-list seed needs no atomics.
+    uint32_t x = list->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    list->seed = x;
+
+    int level = 1;
+    while (level < SLIST_MAX_LEVEL && (x & 3) == 0) {
+        level++;
+        x >>= 2;
+    }
+    return level;
+}
+
+// Returns the forward pointer array that node (or the head, for NULL) uses.
+static SNode ** forward(SList * list, SNode * node) {
+    return node ? node->next : list->head;
+}
+
+// Fills update[i] with the last node on level i that sorts before data
+// (NULL for the head) and returns the node after it on level 0. With
+// past_equal set, nodes equal to data also count as before it.
+static SNode * search_unlocked(SList * list, uint16_t data, bool past_equal, SNode ** update) {
+    SNode * current = NULL;
+    for (int i = list->level - 1; i >= 0; i--) {
+        SNode * next;
+        while ((next = forward(list, current)[i]) &&
+               (next->data < data || (past_equal && next->data == data))) {
+            current = next;
+        }
+        if (update) update[i] = current;
+    }
+    return forward(list, current)[0];
+}
+
+void slist_create(SList * list) {
+    for (int i = 0; i < SLIST_MAX_LEVEL; i++) {
+        list->head[i] = NULL;
+    }
+    list->level = 1;
+    list->count = 0;
+    list->seed = 0x9e3779b9u ^ (uint32_t)(uintptr_t)list;
+    if (!list->seed) list->seed = 1;
+    sync_lock_init(&list->lock);
+}
+
+void slist_destroy(SList * list) {
+    sync_lock(&list->lock);
+
+    SNode * current = list->head[0];
+    while (current) {
+        SNode * next = current->next[0];
+        mem_free(current);
+        current = next;
+    }
+    for (int i = 0; i < SLIST_MAX_LEVEL; i++) {
+        list->head[i] = NULL;
+    }
+    list->level = 1;
+    list->count = 0;
+
+    sync_unlock(&list->lock);
+    sync_lock_destroy(&list->lock);
+}
+
+SNode * slist_insert(SList * list, uint16_t data) {
+    sync_lock(&list->lock);
+
+    // New nodes go after any equal values, keeping insertion order.
+    SNode * update[SLIST_MAX_LEVEL];
+    search_unlocked(list, data, true, update);
+
+    int level = random_level(list);
+    SNode * node = mem_alloc(sizeof(SNode) + level * sizeof(SNode *));
+    if (!node) {
+        printf("Failed to allocate new node.\n");
+        sync_unlock(&list->lock);
+        return NULL;
+    }
+    node->data = data;
+    node->level = (uint8_t)level;
+
+    for (int i = list->level; i < level; i++) {
+        update[i] = NULL;
+    }
+    if (level > list->level) list->level = level;
+    for (int i = 0; i < level; i++) {
+        SNode ** links = forward(list, update[i]);
+        node->next[i] = links[i];
+        links[i] = node;
+    }
+    list->count++;
+
+    sync_unlock(&list->lock);
+    return node;
+}
+
+int slist_remove(SList * list, uint16_t data) {
+    sync_lock(&list->lock);
+
+    SNode * update[SLIST_MAX_LEVEL];
+    SNode * node = search_unlocked(list, data, false, update);
+    if (!node || node->data != data) {
+        sync_unlock(&list->lock);
+        return 0;
+    }
+
+    for (int i = 0; i < node->level; i++) {
+        forward(list, update[i])[i] = node->next[i];
+    }
+    while (list->level > 1 && !list->head[list->level - 1]) {
+        list->level--;
+    }
+    list->count--;
+    mem_free(node);
+
+    sync_unlock(&list->lock);
+    return 1;
+}
+
+SNode * slist_lower_bound(SList * list, uint16_t data) {
+    sync_lock(&list->lock);
+    SNode * found = search_unlocked(list, data, false, NULL);
+    sync_unlock(&list->lock);
+    return found;
+}
+
+SNode * slist_find(SList * list, uint16_t data) {
+    SNode * found = slist_lower_bound(list, data);
+    return found && found->data == data ? found : NULL;
+}
+
+size_t slist_count_range(SList * list, uint16_t low, uint16_t high) {
+    sync_lock(&list->lock);
+    size_t count = 0;
+    for (SNode * current = search_unlocked(list, low, false, NULL); current && current->data <= high;
+         current = current->next[0]) {
+        count++;
+    }
+    sync_unlock(&list->lock);
+    return count;
+}
+
+int slist_fprint_range(SList * list, FILE * stream, uint16_t low, uint16_t high) {
+    RenderBuf * buf = render_pool_get();
+
+    sync_lock(&list->lock);
+    render_bytes(buf, "[", 1);
+    bool first = true;
+    for (SNode * current = search_unlocked(list, low, false, NULL); current && current->data <= high;
+         current = current->next[0]) {
+        render_item(buf, current->data, first);
+        first = false;
+    }
+    render_bytes(buf, "]", 1);
+    sync_unlock(&list->lock);
+
+    return render_emit(buf, stream, -1);
+}
+
+void slist_print_range(SList * list, uint16_t low, uint16_t high) {
+    if (slist_fprint_range(list, stdout, low, high) < 0) {
+        printf("Failed to display list.\n");
+    }
+}
+
+size_t slist_length(SList * list) {
+    sync_lock(&list->lock);
+    size_t count = list->count;
+    sync_unlock(&list->lock);
+    return count;
+}
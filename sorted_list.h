@@ -0,0 +1,48 @@
+#ifndef SORTED_LIST_H
+#define SORTED_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "sync_lock.h"
+
+// Enough levels for 4^16 values with one level added per 4x growth.
+#define SLIST_MAX_LEVEL 16
+
+// Sorted list backed by a skip list. Level 0 links every node in ascending
+// order (equal values in insertion order); each higher level links about a
+// quarter of the nodes of the level below, so insert, find, remove and
+// locating the start of a value range are O(log n) on average. Nodes are
+// sized for their level and come from the memory manager pool, which must
+// be initialised (mem_init) before slist_create. Each SList has its own
+// lock.
+typedef struct SNode {
+    uint16_t data;
+    uint8_t level;
+    struct SNode * next[];  // level entries
+} SNode;
+
+typedef struct SList {
+    SNode * head[SLIST_MAX_LEVEL];
+    int level;
+    size_t count;
+    uint32_t seed;
+    SyncLock lock;
+} SList;
+
+void slist_create(SList * list);
+void slist_destroy(SList * list);
+// Returns the new node, or NULL if the pool is full.
+SNode * slist_insert(SList * list, uint16_t data);
+// Removes the first node holding data; returns 1 if one was found.
+int slist_remove(SList * list, uint16_t data);
+SNode * slist_find(SList * list, uint16_t data);
+// First node holding a value >= data, or NULL.
+SNode * slist_lower_bound(SList * list, uint16_t data);
+size_t slist_count_range(SList * list, uint16_t low, uint16_t high);
+// Prints "[a, b, c]" for every value in [low, high].
+void slist_print_range(SList * list, uint16_t low, uint16_t high);
+int slist_fprint_range(SList * list, FILE * stream, uint16_t low, uint16_t high);
+size_t slist_length(SList * list);
+
+#endif // SORTED_LIST_H
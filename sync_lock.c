@@ -0,0 +1,228 @@
+#include "sync_lock.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#ifndef SYNC_LOCK_MUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+// Pause rounds a contended acquisition spins before parking.
+#define SPIN_LIMIT 128
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+#ifndef SYNC_LOCK_MUTEX
+static void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+ * With one CPU the holder cannot run while a waiter spins, so spinning
+ * only delays the park. Computed on first use; racing threads store the
+ * same value.
+ */
+static int spin_limit(void) {
+    static int limit = -1;
+    int value = __atomic_load_n(&limit, __ATOMIC_RELAXED);
+    if (value < 0) {
+        value = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SPIN_LIMIT : 0;
+        __atomic_store_n(&limit, value, __ATOMIC_RELAXED);
+    }
+    return value;
+}
+
+static void futex_wait(unsigned* word, unsigned expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake(unsigned* word, int count) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#endif
+
+// Called with the lock held after a contended acquisition.
+static void count_contended(SyncLock* lock, uint64_t start, int spun, size_t parks) {
+    lock->stats.contended++;
+    lock->stats.spun += spun;
+    lock->stats.parks += parks;
+    lock->stats.wait_ns += now_ns() - start;
+}
+
+#if defined(SYNC_LOCK_MUTEX)
+
+void sync_lock_init(SyncLock* lock) {
+    pthread_mutex_init(&lock->mutex, NULL);
+    lock->stats = (SyncLockStats){ 0 };
+}
+
+void sync_lock_destroy(SyncLock* lock) {
+    pthread_mutex_destroy(&lock->mutex);
+}
+
+void sync_lock(SyncLock* lock) {
+    if (pthread_mutex_trylock(&lock->mutex) != 0) {
+        uint64_t start = now_ns();
+        pthread_mutex_lock(&lock->mutex);
+        count_contended(lock, start, 0, 0);
+    }
+    lock->stats.acquisitions++;
+}
+
+int sync_trylock(SyncLock* lock) {
+    if (pthread_mutex_trylock(&lock->mutex) != 0) return 0;
+    lock->stats.acquisitions++;
+    return 1;
+}
+
+void sync_unlock(SyncLock* lock) {
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+const char* sync_lock_kind(void) {
+    return "mutex";
+}
+
+#elif defined(SYNC_LOCK_TICKET)
+
+/*
+ * A waiter spins until its ticket is served, then parks on serving. The
+ * unlocker bumps serving and, if anyone may be asleep, wakes all of them,
+ * since only the sleeper holding the next ticket can proceed. sleepers and
+ * serving are paired sequentially consistent so that either the sleeper
+ * sees the new ticket or the unlocker sees the sleeper.
+ */
+void sync_lock_init(SyncLock* lock) {
+    lock->next = 0;
+    lock->serving = 0;
+    lock->sleepers = 0;
+    lock->stats = (SyncLockStats){ 0 };
+}
+
+void sync_lock_destroy(SyncLock* lock) {
+    (void)lock;
+}
+
+void sync_lock(SyncLock* lock) {
+    unsigned ticket = __atomic_fetch_add(&lock->next, 1, __ATOMIC_RELAXED);
+    if (__atomic_load_n(&lock->serving, __ATOMIC_ACQUIRE) == ticket) {
+        lock->stats.acquisitions++;
+        return;
+    }
+
+    uint64_t start = now_ns();
+    int limit = spin_limit();
+    for (int i = 0; i < limit; i++) {
+        cpu_relax();
+        if (__atomic_load_n(&lock->serving, __ATOMIC_ACQUIRE) == ticket) {
+            count_contended(lock, start, 1, 0);
+            lock->stats.acquisitions++;
+            return;
+        }
+    }
+
+    size_t parks = 0;
+    __atomic_add_fetch(&lock->sleepers, 1, __ATOMIC_SEQ_CST);
+    unsigned serving;
+    while ((serving = __atomic_load_n(&lock->serving, __ATOMIC_SEQ_CST)) != ticket) {
+        futex_wait(&lock->serving, serving);
+        parks++;
+    }
+    __atomic_sub_fetch(&lock->sleepers, 1, __ATOMIC_RELAXED);
+    count_contended(lock, start, 0, parks);
+    lock->stats.acquisitions++;
+}
+
+int sync_trylock(SyncLock* lock) {
+    unsigned serving = __atomic_load_n(&lock->serving, __ATOMIC_ACQUIRE);
+    unsigned expected = serving;
+    if (!__atomic_compare_exchange_n(&lock->next, &expected, serving + 1, false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    lock->stats.acquisitions++;
+    return 1;
+}
+
+void sync_unlock(SyncLock* lock) {
+    __atomic_add_fetch(&lock->serving, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&lock->sleepers, __ATOMIC_SEQ_CST) > 0) futex_wake(&lock->serving, INT_MAX);
+}
+
+const char* sync_lock_kind(void) {
+    return "ticket";
+}
+
+#else
+
+/*
+ * Three-state futex lock: 0 free, 1 held, 2 held and someone may be
+ * parked. A waiter that gives up spinning swaps in 2 before sleeping, so
+ * the unlocker knows to wake one; a woken waiter takes the lock as 2
+ * since others may still be asleep.
+ */
+void sync_lock_init(SyncLock* lock) {
+    lock->state = 0;
+    lock->stats = (SyncLockStats){ 0 };
+}
+
+void sync_lock_destroy(SyncLock* lock) {
+    (void)lock;
+}
+
+void sync_lock(SyncLock* lock) {
+    unsigned state = 0;
+    if (__atomic_compare_exchange_n(&lock->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        lock->stats.acquisitions++;
+        return;
+    }
+
+    uint64_t start = now_ns();
+    int limit = spin_limit();
+    for (int i = 0; i < limit; i++) {
+        cpu_relax();
+        state = 0;
+        if (__atomic_load_n(&lock->state, __ATOMIC_RELAXED) == 0
+            && __atomic_compare_exchange_n(&lock->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            count_contended(lock, start, 1, 0);
+            lock->stats.acquisitions++;
+            return;
+        }
+    }
+
+    size_t parks = 0;
+    while (__atomic_exchange_n(&lock->state, 2, __ATOMIC_ACQUIRE) != 0) {
+        futex_wait(&lock->state, 2);
+        parks++;
+    }
+    count_contended(lock, start, 0, parks);
+    lock->stats.acquisitions++;
+}
+
+int sync_trylock(SyncLock* lock) {
+    unsigned state = 0;
+    if (!__atomic_compare_exchange_n(&lock->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+    lock->stats.acquisitions++;
+    return 1;
+}
+
+void sync_unlock(SyncLock* lock) {
+    if (__atomic_exchange_n(&lock->state, 0, __ATOMIC_RELEASE) == 2) futex_wake(&lock->state, 1);
+}
+
+const char* sync_lock_kind(void) {
+    return "adaptive";
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SYNC_LOCK_H
+#define SYNC_LOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Lock used by the allocator and the list handles. The implementation is
+ * chosen at build time (make LOCK=...):
+ *   SYNC_LOCK_ADAPTIVE (default)  spins briefly with a pause instruction,
+ *                                 then parks on a futex; no spinning when
+ *                                 only one CPU is online
+ *   SYNC_LOCK_TICKET              FIFO ticket lock, spinning and then
+ *                                 parking like the adaptive lock
+ *   SYNC_LOCK_MUTEX               plain pthread mutex
+ * Everything linked together must be built with the same choice, since the
+ * size of SyncLock depends on it.
+ */
+#if !defined(SYNC_LOCK_MUTEX) && !defined(SYNC_LOCK_TICKET) && !defined(SYNC_LOCK_ADAPTIVE)
+#define SYNC_LOCK_ADAPTIVE
+#endif
+
+#ifdef SYNC_LOCK_MUTEX
+#include <pthread.h>
+#endif
+
+// Counted by the thread that takes the lock while it holds it, so read
+// them with the lock held. The mutex build cannot tell spinning from
+// parking and leaves spun and parks at 0.
+typedef struct SyncLockStats {
+    size_t acquisitions;
+    size_t contended;  // Acquisitions that found the lock taken
+    size_t spun;       // Contended acquisitions that got it while spinning
+    size_t parks;      // Times a waiter went to sleep
+    uint64_t wait_ns;  // Time spent in contended acquisitions
+} SyncLockStats;
+
+typedef struct SyncLock {
+#if defined(SYNC_LOCK_MUTEX)
+    pthread_mutex_t mutex;
+#elif defined(SYNC_LOCK_TICKET)
+    unsigned next;     // Next ticket to hand out
+    unsigned serving;  // Ticket that holds the lock
+    unsigned sleepers;
+#else
+    unsigned state;    // 0 free, 1 held, 2 held with possible sleepers
+#endif
+    SyncLockStats stats;
+} SyncLock;
+
+#if defined(SYNC_LOCK_MUTEX)
+#define SYNC_LOCK_INIT { PTHREAD_MUTEX_INITIALIZER, { 0 } }
+#elif defined(SYNC_LOCK_TICKET)
+#define SYNC_LOCK_INIT { 0, 0, 0, { 0 } }
+#else
+#define SYNC_LOCK_INIT { 0, { 0 } }
+#endif
+
+void sync_lock_init(SyncLock* lock);
+void sync_lock_destroy(SyncLock* lock);
+void sync_lock(SyncLock* lock);
+// Takes the lock if it is free and returns 1, else returns 0 at once.
+int sync_trylock(SyncLock* lock);
+void sync_unlock(SyncLock* lock);
+// "adaptive", "ticket" or "mutex".
+const char* sync_lock_kind(void);
+
+#endif
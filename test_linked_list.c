@@ -1,4 +1,18 @@
 #include "linked_list.h"
+#include "memory_manager.h"
+#include "unrolled_list.h"
+#include "simd_scan.h"
+#include "concurrent_list.h"
+#include "doubly_linked_list.h"
+#include "sorted_list.h"
+#include "offset_list.h"
+#include "rcu_list.h"
+#include "rcu.h"
+#include "list_snapshot.h"
+#include "list_parallel.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -164,10 +178,10 @@ void test_list_display()
     printf("Random [%d,%d] delta= %d \n", randomLow, randomHigh, Delta);
 #endif
 
-    char *stringFull = malloc(1024);
-    char *string2Last = malloc(1024);
-    char *string1third = malloc(1024);
-    char *stringRandom = malloc(1024);
+    char *stringFull = calloc(1, 1024);
+    char *string2Last = calloc(1, 1024);
+    char *string1third = calloc(1, 1024);
+    char *stringRandom = calloc(1, 1024);
 
     sprintf(stringFull, "[");
     sprintf(string2Last, "[");
@@ -264,7 +278,7 @@ void test_list_display()
 
 #endif
 
-    char *blob = malloc(1024);
+    char *blob = calloc(1, 1024);
     strncpy(blob, start, LenToLast - LenToFirst);
 
     sprintf(stringRandom, "[%s", blob);
@@ -483,6 +497,1258 @@ void test_list_edge_cases()
     printf_green("[PASS].\n");
 }
 
+// ********* List handle *********
+
+void test_list_handle_append()
+{
+    printf_yellow("  Testing list_append ---> ");
+    List list;
+    mem_init(sizeof(Node) * 3);
+    list_create(&list);
+    my_assert(list_length(&list) == 0);
+    list_append(&list, 10);
+    list_append(&list, 20);
+    list_prepend(&list, 5);
+    my_assert(list.head->data == 5);
+    my_assert(list.head->next->data == 10);
+    my_assert(list.tail->data == 20);
+    my_assert(list.tail->next == NULL);
+    my_assert(list_length(&list) == 3);
+    list_destroy(&list);
+    my_assert(list.head == NULL && list.tail == NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_handle_tail_tracking()
+{
+    printf_yellow("  Testing list handle tail tracking ---> ");
+    List list;
+    mem_init(sizeof(Node) * 6);
+    list_create(&list);
+    list_append(&list, 10);
+    list_add_after(&list, list.tail, 30);
+    my_assert(list.tail->data == 30);
+    list_add_before(&list, list.tail, 20);
+    list_add_before(&list, list.head, 0);
+    my_assert(list.head->data == 0);
+    my_assert(list_length(&list) == 4);
+
+    list_remove(&list, 30);
+    my_assert(list.tail->data == 20);
+    list_append(&list, 40);
+    my_assert(list.tail->data == 40);
+    my_assert(list_find(&list, 20)->next == list.tail);
+
+    list_remove(&list, 0);
+    list_remove(&list, 10);
+    list_remove(&list, 20);
+    list_remove(&list, 40);
+    my_assert(list.head == NULL && list.tail == NULL);
+    my_assert(list_length(&list) == 0);
+    list_append(&list, 50);
+    my_assert(list.head == list.tail);
+
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_insert_after_tail()
+{
+    printf_yellow("  Testing list_insert after tail extension ---> ");
+    Node *head = NULL;
+    list_init(&head, sizeof(Node) * 4);
+    list_insert(&head, 10);
+    list_insert(&head, 20);
+    list_insert_after(head->next, 30);
+    list_insert(&head, 40);
+    my_assert(head->next->next->data == 30);
+    my_assert(head->next->next->next->data == 40);
+    list_delete(&head, 40);
+    list_insert(&head, 50);
+    my_assert(head->next->next->next->data == 50);
+    my_assert(list_count_nodes(&head) == 4);
+    list_cleanup(&head);
+    printf_green("[PASS].\n");
+}
+
+// ********* Unrolled list *********
+
+void test_ulist_insert_and_split()
+{
+    printf_yellow("  Testing unrolled list insert and split ---> ");
+    UList list;
+    int n = UNODE_CAPACITY * 3;
+    mem_init(sizeof(UNode) * 8);
+    ulist_init(&list);
+    for (int i = 0; i < n; i++)
+    {
+        ulist_insert(&list, i);
+    }
+    my_assert(ulist_count_nodes(&list) == (size_t)n);
+    my_assert(list.head->count == UNODE_CAPACITY);
+
+    // Inserting into a full node splits it.
+    UPos pos = ulist_search(&list, 5);
+    my_assert(pos.node == list.head && pos.index == 5);
+    ulist_insert_after(&list, pos, 1000);
+    ulist_insert_before(&list, ulist_search(&list, 0), 2000);
+    my_assert(list.head->values[0] == 2000);
+    my_assert(ulist_count_nodes(&list) == (size_t)n + 2);
+
+    UPos after = ulist_search(&list, 1000);
+    UPos five = ulist_search(&list, 5);
+    UPos six = ulist_search(&list, 6);
+    my_assert(after.node == five.node && after.index == five.index + 1);
+    my_assert(six.node != after.node || six.index == after.index + 1);
+
+    int expected = 0;
+    for (UNode *node = list.head; node; node = node->next)
+    {
+        for (int i = 0; i < node->count; i++)
+        {
+            uint16_t value = node->values[i];
+            if (value == 1000 || value == 2000)
+                continue;
+            my_assert(value == expected);
+            expected++;
+        }
+    }
+    my_assert(expected == n);
+
+    ulist_cleanup(&list);
+    my_assert(list.head == NULL && list.count == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_ulist_delete()
+{
+    printf_yellow("  Testing unrolled list delete ---> ");
+    UList list;
+    int n = UNODE_CAPACITY * 2;
+    mem_init(sizeof(UNode) * 4);
+    ulist_init(&list);
+    for (int i = 0; i < n; i++)
+    {
+        ulist_insert(&list, i);
+    }
+
+    for (int i = 0; i < n; i += 2)
+    {
+        ulist_delete(&list, i);
+    }
+    my_assert(ulist_count_nodes(&list) == (size_t)n / 2);
+    my_assert(list.head->next == NULL); // Both halves fit one node again
+    my_assert(ulist_search(&list, 4).node == NULL);
+    my_assert(ulist_search(&list, 5).node != NULL);
+
+    for (int i = 1; i < n; i += 2)
+    {
+        ulist_delete(&list, i);
+    }
+    my_assert(list.head == NULL && list.tail == NULL);
+    ulist_insert(&list, 7);
+    my_assert(list.head == list.tail && list.head->values[0] == 7);
+
+    ulist_cleanup(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// capture_stdout only passes Node pointers, so the range is staged here.
+static UList *display_list;
+static UPos display_from;
+static UPos display_to;
+
+void call_ulist_display_range(Node **head, Node *start, Node *end)
+{
+    ulist_display_range(display_list, display_from, display_to);
+}
+
+void test_ulist_display()
+{
+    printf_yellow("  Testing unrolled list display ---> ");
+    UList list;
+    char buffer[256] = {0};
+    mem_init(sizeof(UNode) * 2);
+    ulist_init(&list);
+    for (int i = 0; i < UNODE_CAPACITY + 3; i++)
+    {
+        ulist_insert(&list, i);
+    }
+
+    display_list = &list;
+    display_from.node = NULL;
+    capture_stdout(buffer, sizeof(buffer), call_ulist_display_range, NULL, NULL, NULL);
+    my_assert(strncmp(buffer, "[0, 1, 2, ", 10) == 0);
+    my_assert(strstr(buffer, ", 28, 29]") != NULL);
+
+    memset(buffer, 0, sizeof(buffer));
+    display_from.node = list.head;
+    display_from.index = 1;
+    display_to.node = list.tail;
+    display_to.index = 0;
+    capture_stdout(buffer, sizeof(buffer), call_ulist_display_range, NULL, NULL, NULL);
+    my_assert(strncmp(buffer, "[1, 2, ", 7) == 0);
+    my_assert(strstr(buffer, ", 26, 27]") != NULL);
+
+    memset(buffer, 0, sizeof(buffer));
+    display_from.node = list.tail;
+    display_from.index = 1;
+    display_to.index = 2;
+    capture_stdout(buffer, sizeof(buffer), call_ulist_display_range, NULL, NULL, NULL);
+    my_assert(strcmp(buffer, "[28, 29]") == 0);
+
+    ulist_cleanup(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* SIMD scans *********
+
+void test_simd_kernels()
+{
+    printf_yellow("  Testing SIMD find/count kernels ---> ");
+    uint16_t values[1100];
+
+    for (int level = SIMD_SCALAR; level <= SIMD_AVX2; level++)
+    {
+        simd_set_level((SimdLevel)level);
+        for (int n = 0; n <= 1100; n += (n < 80 ? 1 : 97))
+        {
+            for (int i = 0; i < n; i++)
+            {
+                values[i] = rand() % 8;
+            }
+            for (uint16_t key = 0; key < 9; key++)
+            {
+                long first = -1;
+                size_t count = 0;
+                for (int i = 0; i < n; i++)
+                {
+                    if (values[i] != key)
+                        continue;
+                    if (first < 0)
+                        first = i;
+                    count++;
+                }
+                my_assert(u16_find(values, n, key) == first);
+                my_assert(u16_count(values, n, key) == count);
+            }
+        }
+    }
+
+    // A match in the last lane of an unaligned slice.
+    values[0] = 1;
+    for (int i = 1; i < 40; i++)
+        values[i] = 2;
+    values[39] = 1;
+    simd_set_level(simd_detect());
+    my_assert(u16_find(values + 1, 39, 1) == 38);
+    my_assert(u16_count(values + 1, 39, 1) == 1);
+
+    printf_green("[PASS].\n");
+}
+
+void test_ulist_count_and_delete_all()
+{
+    printf_yellow("  Testing unrolled list count and delete all ---> ");
+    UList list;
+    int n = UNODE_CAPACITY * 4;
+    mem_init(sizeof(UNode) * 5);
+    ulist_init(&list);
+    for (int i = 0; i < n; i++)
+    {
+        ulist_insert(&list, i % 3);
+    }
+
+    my_assert(ulist_count_value(&list, 0) == (size_t)n / 3);
+    my_assert(ulist_count_value(&list, 3) == 0);
+
+    my_assert(ulist_delete_all(&list, 1) == (size_t)n / 3);
+    my_assert(ulist_count_value(&list, 1) == 0);
+    my_assert(ulist_count_nodes(&list) == (size_t)n * 2 / 3);
+    my_assert(ulist_search(&list, 1).node == NULL);
+
+    size_t seen = 0;
+    for (UNode *node = list.head; node; node = node->next)
+    {
+        for (int i = 0; i < node->count; i++)
+            my_assert(node->values[i] == seen++ % 2 * 2);
+        if (!node->next)
+            my_assert(list.tail == node);
+    }
+    my_assert(seen == ulist_count_nodes(&list));
+
+    my_assert(ulist_delete_all(&list, 0) == (size_t)n / 3);
+    my_assert(ulist_delete_all(&list, 2) == (size_t)n / 3);
+    my_assert(list.head == NULL && list.tail == NULL);
+
+    ulist_cleanup(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Value index *********
+
+static void assert_same_list(List *a, List *b)
+{
+    Node *x = a->head;
+    Node *y = b->head;
+    while (x && y)
+    {
+        my_assert(x->data == y->data);
+        x = x->next;
+        y = y->next;
+    }
+    my_assert(x == NULL && y == NULL);
+    my_assert(a->count == b->count);
+    my_assert((a->tail == NULL) == (b->tail == NULL));
+    if (a->tail)
+        my_assert(a->tail->data == b->tail->data && a->tail->next == NULL);
+}
+
+void test_list_index_matches_plain()
+{
+    printf_yellow("  Testing indexed list against a plain list ---> ");
+    List plain;
+    List indexed;
+    int ops = 4000;
+    mem_init(sizeof(Node) * ops * 2);
+    list_create(&plain);
+    list_create_indexed(&indexed);
+    my_assert(indexed.index != NULL);
+
+    // Distinct values keep "first match" and "oldest match" identical.
+    uint16_t next_value = 0;
+    for (int i = 0; i < ops; i++)
+    {
+        int op = rand() % 5;
+        uint16_t target = rand() % (next_value + 1);
+        Node *p = list_find(&plain, target);
+        Node *q = list_find(&indexed, target);
+        my_assert((p == NULL) == (q == NULL));
+        if (p)
+            my_assert(p->data == target && q->data == target);
+
+        switch (op)
+        {
+        case 0:
+            list_append(&plain, next_value);
+            list_append(&indexed, next_value++);
+            break;
+        case 1:
+            list_prepend(&plain, next_value);
+            list_prepend(&indexed, next_value++);
+            break;
+        case 2:
+            if (p)
+            {
+                list_add_after(&plain, p, next_value);
+                list_add_after(&indexed, q, next_value++);
+            }
+            break;
+        case 3:
+            if (p)
+            {
+                list_add_before(&plain, p, next_value);
+                list_add_before(&indexed, q, next_value++);
+            }
+            break;
+        default:
+            list_remove(&plain, target);
+            list_remove(&indexed, target);
+            break;
+        }
+        assert_same_list(&plain, &indexed);
+    }
+
+    list_destroy(&plain);
+    list_destroy(&indexed);
+    my_assert(indexed.index == NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_index_duplicates()
+{
+    printf_yellow("  Testing indexed list with duplicate values ---> ");
+    List list;
+    mem_init(sizeof(Node) * 6);
+    list_create_indexed(&list);
+    list_append(&list, 7);
+    list_append(&list, 8);
+    list_append(&list, 7);
+    list_append(&list, 7);
+
+    Node *first = list.head;
+    my_assert(list_find(&list, 7) == first);
+    list_remove(&list, 7);
+    my_assert(list.head->data == 8);
+    my_assert(list_find(&list, 7) == list.head->next);
+
+    // Inserting before an indexed node needs no walk to its predecessor.
+    list_add_before(&list, list.tail, 9);
+    my_assert(list.head->next->next->data == 9);
+    list_remove(&list, 7);
+    list_remove(&list, 7);
+    my_assert(list_find(&list, 7) == NULL);
+    my_assert(list.tail->data == 9 && list_length(&list) == 2);
+    list_destroy(&list);
+    mem_deinit();
+
+    // Thousands of nodes per value: each operation reaches its node's
+    // entry without going through the others holding the same value.
+    const int total = 100000;
+    mem_init(sizeof(Node) * (total + 1000 + 2 * NODE_CACHE_BATCH));
+    list_create_indexed(&list);
+    for (int i = 0; i < total; i++)
+    {
+        list_append(&list, i % 4);
+    }
+    Node *last = list.tail;
+    for (int i = 0; i < 1000; i++)
+    {
+        list_add_before(&list, last, 9);
+    }
+    for (int i = 0; i < total - 1; i++)
+    {
+        my_assert(list_find(&list, i % 4) == list.head);
+        list_remove(&list, i % 4);
+    }
+    my_assert(list_find(&list, 3) == last);
+    list_remove(&list, 3);
+    my_assert(list_length(&list) == 1000 && list.head->data == 9 && list.tail->data == 9);
+    my_assert(list_find(&list, 9) == list.head && list_find(&list, 3) == NULL);
+
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Concurrency *********
+
+#define CONCURRENT_THREADS 4
+#define CONCURRENT_OPS 500
+
+typedef struct ThreadArgs
+{
+    List *list;
+    CList *clist;
+    int id;
+} ThreadArgs;
+
+void *append_worker(void *arg)
+{
+    ThreadArgs *args = arg;
+    for (int i = 0; i < CONCURRENT_OPS; i++)
+    {
+        list_append(args->list, args->id * CONCURRENT_OPS + i);
+    }
+    return NULL;
+}
+
+void test_list_per_list_locks()
+{
+    printf_yellow("  Testing concurrent appends on separate lists ---> ");
+    List lists[2];
+    pthread_t threads[CONCURRENT_THREADS];
+    ThreadArgs args[CONCURRENT_THREADS];
+    // Each list may hold back one batch of spare nodes.
+    mem_init(sizeof(Node) * (CONCURRENT_THREADS * CONCURRENT_OPS + 2 * NODE_CACHE_BATCH));
+    list_create(&lists[0]);
+    list_create(&lists[1]);
+
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        args[t].list = &lists[t % 2];
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, append_worker, &args[t]);
+    }
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    for (int l = 0; l < 2; l++)
+    {
+        size_t expected = CONCURRENT_THREADS / 2 * CONCURRENT_OPS;
+        my_assert(list_length(&lists[l]) == expected);
+        size_t walked = 0;
+        for (Node *node = lists[l].head; node; node = node->next)
+        {
+            my_assert(node->data / CONCURRENT_OPS % 2 == l);
+            walked++;
+        }
+        my_assert(walked == expected);
+        list_destroy(&lists[l]);
+    }
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void *clist_worker(void *arg)
+{
+    ThreadArgs *args = arg;
+    int base = args->id * CONCURRENT_OPS;
+    for (int i = 0; i < CONCURRENT_OPS; i++)
+    {
+        if (i % 2)
+            clist_push_front(args->clist, base + i);
+        else
+            clist_insert(args->clist, base + i);
+    }
+    for (int i = 0; i < CONCURRENT_OPS; i += 2)
+    {
+        my_assert(clist_delete(args->clist, base + i));
+        my_assert(!clist_contains(args->clist, base + i));
+        my_assert(clist_contains(args->clist, base + i + 1));
+    }
+    return NULL;
+}
+
+void test_clist_concurrent()
+{
+    printf_yellow("  Testing hand-over-hand list under concurrency ---> ");
+    CList list;
+    pthread_t threads[CONCURRENT_THREADS];
+    ThreadArgs args[CONCURRENT_THREADS];
+    mem_init(sizeof(CNode) * CONCURRENT_THREADS * CONCURRENT_OPS);
+    clist_init(&list);
+
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        args[t].clist = &list;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, clist_worker, &args[t]);
+    }
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    size_t expected = CONCURRENT_THREADS * CONCURRENT_OPS / 2;
+    my_assert(clist_count_nodes(&list) == expected);
+    size_t walked = 0;
+    for (CNode *node = list.head.next; node; node = node->next)
+    {
+        my_assert(node->data % 2 == 1);
+        walked++;
+    }
+    my_assert(walked == expected);
+
+    clist_cleanup(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_node_cache()
+{
+    printf_yellow("  Testing list node cache ---> ");
+    List list;
+    MemStats stats;
+    int count = NODE_CACHE_BATCH * 5;
+    mem_init(sizeof(Node) * count);
+    list_create(&list);
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i);
+    }
+    my_assert(list_length(&list) == (size_t)count); // The last batch may be short
+
+    for (int i = 0; i < count; i++)
+    {
+        list_remove(&list, i);
+    }
+    my_assert(list.head == NULL && list_length(&list) == 0);
+    my_assert(list.cache.count <= 2 * NODE_CACHE_BATCH);
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == list.cache.count);
+
+    // Spare nodes are reused before the pool is asked again.
+    Node *spare = list.cache.spare;
+    list_append(&list, 7);
+    my_assert(list.head == spare);
+
+    list_destroy(&list);
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_format_output()
+{
+    printf_yellow("  Testing buffered list formatting ---> ");
+    List list;
+    char buffer[64];
+    const char *expected = "[0, 9, 10, 99, 100, 65535]";
+    uint16_t values[] = {0, 9, 10, 99, 100, 65535};
+    mem_init(sizeof(Node) * 8);
+    list_create(&list);
+    for (int i = 0; i < 6; i++)
+    {
+        list_append(&list, values[i]);
+    }
+
+    my_assert(list_format_range(&list, NULL, NULL, buffer, sizeof(buffer)) == strlen(expected));
+    my_assert(strcmp(buffer, expected) == 0);
+    list_format_range(&list, list.head->next, list.head->next->next, buffer, sizeof(buffer));
+    my_assert(strcmp(buffer, "[9, 10]") == 0);
+
+    // Too small a buffer is truncated, mid-item if need be, but the full
+    // length is reported.
+    memset(buffer, 'X', sizeof(buffer));
+    my_assert(list_format_range(&list, NULL, NULL, buffer, 7) == strlen(expected));
+    my_assert(strcmp(buffer, "[0, 9,") == 0);
+
+    FILE *fp = tmpfile();
+    my_assert(fp != NULL);
+    my_assert(list_fprint_range(&list, fp, NULL, NULL) == 0);
+    rewind(fp);
+    memset(buffer, 0, sizeof(buffer));
+    my_assert(fread(buffer, 1, sizeof(buffer) - 1, fp) == strlen(expected));
+    my_assert(strcmp(buffer, expected) == 0);
+    fclose(fp);
+
+    int fds[2];
+    my_assert(pipe(fds) == 0);
+    my_assert(list_write_range(&list, fds[1], list.tail, NULL) == 0);
+    memset(buffer, 0, sizeof(buffer));
+    my_assert(read(fds[0], buffer, sizeof(buffer) - 1) == 7);
+    my_assert(strcmp(buffer, "[65535]") == 0);
+    close(fds[0]);
+    close(fds[1]);
+
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_array_roundtrip()
+{
+    printf_yellow("  Testing bulk array import and export ---> ");
+    List list;
+    List indexed;
+    uint16_t values[100];
+    uint16_t out[150];
+    for (int i = 0; i < 100; i++)
+    {
+        values[i] = rand() % 1000;
+    }
+    mem_init(sizeof(Node) * (250 + NODE_CACHE_BATCH + 20));
+
+    my_assert(list_from_array(&list, values, 100) == 1);
+    my_assert(list_append_array(&list, values, 50) == 1);
+    my_assert(list_length(&list) == 150 && list.tail->next == NULL);
+    my_assert(list_to_array(&list, out, 150) == 150);
+    my_assert(memcmp(out, values, sizeof(values)) == 0);
+    my_assert(memcmp(out + 100, values, 50 * sizeof(uint16_t)) == 0);
+
+    // A short buffer is filled as far as it goes.
+    memset(out, 0, sizeof(out));
+    my_assert(list_to_array(&list, out, 10) == 150);
+    my_assert(memcmp(out, values, 10 * sizeof(uint16_t)) == 0 && out[10] == 0);
+
+    list_create_indexed(&indexed);
+    list_append(&indexed, 5000);
+    my_assert(list_append_array(&indexed, values, 100) == 1);
+    my_assert(list_find(&indexed, values[42])->data == values[42]);
+    list_remove(&indexed, 5000);
+    my_assert(indexed.head->data == values[0]);
+
+    // The pool has room for 20 more nodes: nothing is added.
+    MemStats before;
+    MemStats after;
+    mem_get_stats(&before);
+    my_assert(list_append_array(&list, values, 100) == 0);
+    mem_get_stats(&after);
+    my_assert(after.used_blocks == before.used_blocks);
+    my_assert(list_length(&list) == 150);
+
+    list_destroy(&indexed);
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_list_compact()
+{
+    printf_yellow("  Testing list compaction ---> ");
+    List list;
+    int count = 1000;
+    Node *nodes[1000];
+    uint16_t before[1000];
+    uint16_t after[1000];
+    mem_init(sizeof(Node) * (count * 2 + NODE_CACHE_BATCH));
+    list_create_indexed(&list);
+
+    // Inserting after random nodes scatters list order across memory.
+    list_append(&list, 0);
+    nodes[0] = list.head;
+    for (int i = 1; i < count; i++)
+    {
+        Node *at = nodes[rand() % i];
+        list_add_after(&list, at, i);
+        nodes[i] = at->next;
+    }
+    my_assert(list_to_array(&list, before, count) == (size_t)count);
+
+    my_assert(list_compact(&list) == 1);
+    my_assert(list_to_array(&list, after, count) == (size_t)count);
+    my_assert(memcmp(before, after, sizeof(before)) == 0);
+    for (Node *node = list.head; node->next; node = node->next)
+    {
+        my_assert(node->next == node + 1);
+    }
+    my_assert(list.tail->next == NULL && list.tail->data == before[count - 1]);
+
+    // The rebuilt index points at the relocated nodes.
+    Node *found = list_find(&list, 500);
+    my_assert(found && found->data == 500);
+    list_remove(&list, 500);
+    my_assert(list_find(&list, 500) == NULL && list_length(&list) == (size_t)count - 1);
+
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == (size_t)count - 1 + list.cache.count);
+
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Doubly linked list *********
+
+// Checks both directions of the list against the expected values.
+static void assert_dlist(DList *list, const uint16_t *expected, size_t count)
+{
+    my_assert(list->count == count);
+    DNode *node = list->head;
+    DNode *prev = NULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        my_assert(node && node->data == expected[i] && node->prev == prev);
+        prev = node;
+        node = node->next;
+    }
+    my_assert(node == NULL && list->tail == prev);
+}
+
+void test_dlist_positional()
+{
+    printf_yellow("  Testing doubly linked list positional operations ---> ");
+    DList list;
+    mem_init(sizeof(DNode) * 8);
+    dlist_create(&list);
+    DNode *b = dlist_append(&list, 20);
+    DNode *a = dlist_insert_before(&list, b, 10); // New head
+    DNode *d = dlist_insert_after(&list, b, 40);  // New tail
+    DNode *c = dlist_insert_before(&list, d, 30);
+    dlist_prepend(&list, 5);
+    const uint16_t full[] = {5, 10, 20, 30, 40};
+    assert_dlist(&list, full, 5);
+    my_assert(dlist_find(&list, 30) == c);
+
+    dlist_delete_node(&list, c);
+    dlist_delete_node(&list, list.head);
+    dlist_delete_node(&list, d);
+    const uint16_t left[] = {10, 20};
+    assert_dlist(&list, left, 2);
+    my_assert(list.head == a && list.tail == b);
+
+    my_assert(dlist_remove(&list, 10) == 1);
+    my_assert(dlist_remove(&list, 10) == 0);
+    dlist_delete_node(&list, b);
+    assert_dlist(&list, NULL, 0);
+    my_assert(dlist_append(&list, 50) == list.head);
+
+    dlist_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_dlist_print_range()
+{
+    printf_yellow("  Testing doubly linked list range display ---> ");
+    DList list;
+    char buffer[64] = {0};
+    mem_init(sizeof(DNode) * 4);
+    dlist_create(&list);
+    dlist_append(&list, 1);
+    DNode *start = dlist_append(&list, 22);
+    DNode *end = dlist_append(&list, 333);
+    dlist_append(&list, 4444);
+
+    FILE *fp = tmpfile();
+    my_assert(fp != NULL);
+    my_assert(dlist_fprint_range(&list, fp, start, end) == 0);
+    my_assert(dlist_fprint_range(&list, fp, end, NULL) == 0);
+    rewind(fp);
+    my_assert(fread(buffer, 1, sizeof(buffer) - 1, fp) > 0);
+    my_assert(strcmp(buffer, "[22, 333][333, 4444]") == 0);
+    fclose(fp);
+
+    dlist_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Sorted list *********
+
+// Every level must be ascending and a subsequence of the level below.
+static void assert_slist_sorted(SList *list, size_t count)
+{
+    size_t walked = 0;
+    for (SNode *node = list->head[0]; node; node = node->next[0])
+    {
+        my_assert(!node->next[0] || node->data <= node->next[0]->data);
+        walked++;
+    }
+    my_assert(walked == count && list->count == count);
+    for (int i = 1; i < list->level; i++)
+    {
+        SNode *below = list->head[0];
+        for (SNode *node = list->head[i]; node; node = node->next[i])
+        {
+            my_assert(node->level > i);
+            while (below && below != node)
+                below = below->next[0];
+            my_assert(below == node);
+        }
+    }
+}
+
+void test_slist_ordered()
+{
+    printf_yellow("  Testing sorted skip list operations ---> ");
+    SList list;
+    int ops = 2000;
+    size_t counts[64] = {0};
+    size_t total = 0;
+    mem_init((sizeof(SNode) + SLIST_MAX_LEVEL * sizeof(SNode *)) * ops);
+    slist_create(&list);
+
+    for (int i = 0; i < ops; i++)
+    {
+        uint16_t value = rand() % 64 * 1000;
+        if (rand() % 3)
+        {
+            my_assert(slist_insert(&list, value) != NULL);
+            counts[value / 1000]++;
+            total++;
+        }
+        else
+        {
+            my_assert(slist_remove(&list, value) == (counts[value / 1000] > 0));
+            if (counts[value / 1000])
+            {
+                counts[value / 1000]--;
+                total--;
+            }
+        }
+    }
+    assert_slist_sorted(&list, total);
+
+    for (int v = 0; v < 64; v++)
+    {
+        SNode *found = slist_find(&list, v * 1000);
+        my_assert((found != NULL) == (counts[v] > 0));
+        my_assert(slist_count_range(&list, v * 1000, v * 1000) == counts[v]);
+    }
+    SNode *bound = slist_lower_bound(&list, 1);
+    my_assert(bound == NULL || bound->data >= 1000);
+
+    // Equal values keep insertion order, and 65535 sorts last.
+    SNode *first = slist_insert(&list, 65535);
+    SNode *second = slist_insert(&list, 65535);
+    my_assert(first && first->next[0] == second && second->next[0] == NULL);
+
+    slist_destroy(&list);
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_slist_print_range()
+{
+    printf_yellow("  Testing sorted list value range display ---> ");
+    SList list;
+    char buffer[64] = {0};
+    uint16_t values[] = {50, 10, 40, 20, 30, 20};
+    mem_init((sizeof(SNode) + SLIST_MAX_LEVEL * sizeof(SNode *)) * 6);
+    slist_create(&list);
+    for (int i = 0; i < 6; i++)
+    {
+        slist_insert(&list, values[i]);
+    }
+
+    FILE *fp = tmpfile();
+    my_assert(fp != NULL);
+    my_assert(slist_fprint_range(&list, fp, 15, 40) == 0);
+    my_assert(slist_fprint_range(&list, fp, 41, 49) == 0);
+    my_assert(slist_fprint_range(&list, fp, 0, 65535) == 0);
+    rewind(fp);
+    my_assert(fread(buffer, 1, sizeof(buffer) - 1, fp) > 0);
+    my_assert(strcmp(buffer, "[20, 20, 30, 40][][10, 20, 20, 30, 40, 50]") == 0);
+    fclose(fp);
+
+    slist_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Offset list *********
+
+void test_olist_offsets()
+{
+    printf_yellow("  Testing 32-bit offset links ---> ");
+    OList list;
+    my_assert(sizeof(ONode) == 8);
+    mem_init(sizeof(ONode) * 8);
+    my_assert(olist_create(&list) == 1);
+    olist_append(&list, 20);
+    olist_append(&list, 40);
+    olist_prepend(&list, 10);
+    olist_insert_after(&list, olist_find(&list, 20), 30);
+    my_assert(olist_length(&list) == 4 && olist_count_nodes(&list) == 4);
+
+    uint16_t expected = 10;
+    for (ONode *node = olist_head(&list); node; node = olist_next(&list, node))
+    {
+        my_assert(node->data == expected);
+        my_assert(mem_at(mem_offset(node)) == node);
+        my_assert(node->next == MEM_NO_OFFSET || mem_at(node->next) == olist_next(&list, node));
+        expected += 10;
+    }
+    my_assert(mem_offset(&list) == MEM_NO_OFFSET); // Not in the pool
+
+    olist_remove(&list, 40);
+    olist_append(&list, 50); // Tail moved back to 30
+    my_assert(olist_find(&list, 30)->next == mem_offset(olist_find(&list, 50)));
+    olist_remove(&list, 10);
+    my_assert(olist_head(&list)->data == 20);
+
+    olist_destroy(&list);
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_olist_persistent()
+{
+    printf_yellow("  Testing offset list in a reopened pool file ---> ");
+    OList list;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_olist_%d.bin", (int)getpid());
+    unlink(path);
+
+    my_assert(mem_init_file(path, sizeof(ONode) * 256) == 0);
+    my_assert(olist_create(&list) == 1);
+    for (int i = 0; i < 100; i++)
+    {
+        olist_append(&list, i * 3);
+    }
+    olist_remove(&list, 0);
+    my_assert(olist_persist(&list) == 1);
+    mem_deinit();
+
+    my_assert(mem_init_file(path, 0) == 1);
+    my_assert(olist_restore(&list) == 1);
+    my_assert(olist_length(&list) == 99 && olist_count_nodes(&list) == 99);
+    uint16_t expected = 3;
+    for (ONode *node = olist_head(&list); node; node = olist_next(&list, node))
+    {
+        my_assert(node->data == expected);
+        expected += 3;
+    }
+    olist_append(&list, 1000); // The tail is usable straight away
+    my_assert(olist_find(&list, 297)->next == mem_offset(olist_find(&list, 1000)));
+
+    olist_destroy(&list);
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0 && mem_get_root() == MEM_NO_OFFSET);
+    mem_deinit();
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+void test_list_snapshot()
+{
+    printf_yellow("  Testing list snapshots ---> ");
+    const uint16_t values[] = {0, 65535, 1, 1, 2, 40000, 39999, 7, 65535, 0};
+    const size_t count = sizeof(values) / sizeof(values[0]);
+    uint16_t out[16];
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_snapshot_%d.bin", (int)getpid());
+    mem_init(sizeof(Node) * (4 * count + 2 * NODE_CACHE_BATCH));
+
+    List list, copy;
+    my_assert(list_from_array(&list, values, count) == 1);
+    int encodings[] = {SNAPSHOT_RAW, SNAPSHOT_DELTA};
+    for (int e = 0; e < 2; e++)
+    {
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        my_assert(list_save(&list, fd, encodings[e]) == 0);
+        my_assert(list_load(&copy, fd) == 1);
+        my_assert(list_to_array(&copy, out, 16) == count);
+        my_assert(memcmp(out, values, sizeof(values)) == 0);
+        list_append(&copy, 5); // The tail is linked up
+        my_assert(copy.tail->data == 5 && list_length(&copy) == count + 1);
+        list_destroy(&copy);
+        close(fd);
+    }
+
+    // Descriptors that cannot be mapped are read instead.
+    int pipe_fds[2];
+    my_assert(pipe(pipe_fds) == 0);
+    my_assert(list_save(&list, pipe_fds[1], SNAPSHOT_DELTA) == 0);
+    close(pipe_fds[1]);
+    my_assert(list_load(&copy, pipe_fds[0]) == 1);
+    my_assert(list_to_array(&copy, out, 16) == count && memcmp(out, values, sizeof(values)) == 0);
+    list_destroy(&copy);
+    close(pipe_fds[0]);
+
+    // A truncated or damaged snapshot leaves the list empty and the pool as it was.
+    MemStats before, after;
+    mem_get_stats(&before);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    list_save(&list, fd, SNAPSHOT_RAW);
+    my_assert(ftruncate(fd, sizeof(SnapshotHeader) + 5) == 0);
+    my_assert(list_load(&copy, fd) == 0 && list_length(&copy) == 0 && copy.head == NULL);
+    list_destroy(&copy);
+    close(fd);
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    list_save(&list, fd, SNAPSHOT_DELTA);
+    uint8_t bad = 0xff; // Unterminated varint in the last value
+    my_assert(pwrite(fd, &bad, 1, lseek(fd, 0, SEEK_END) - 1) == 1);
+    my_assert(list_load(&copy, fd) == 0 && list_length(&copy) == 0);
+    list_destroy(&copy);
+    close(fd);
+    mem_get_stats(&after);
+    my_assert(after.used_blocks == before.used_blocks);
+
+    list_destroy(&list);
+    mem_deinit();
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+static uint64_t add_u64(uint64_t a, uint64_t b) { return a + b; }
+static uint64_t square_u16(uint16_t v) { return (uint64_t)v * v; }
+static bool is_even(uint16_t v) { return v % 2 == 0; }
+static uint16_t halve_u16(uint16_t v) { return v / 2; }
+
+// Reads mapped_list on every call and appends to it while appends_left
+// lasts, so list_map has to start over.
+static List *mapped_list;
+static int appends_left;
+static uint16_t grow_and_shift(uint16_t v)
+{
+    my_assert(list_length(mapped_list) > 0 && list_find(mapped_list, v) != NULL);
+    if (__atomic_fetch_sub(&appends_left, 1, __ATOMIC_RELAXED) > 0)
+        list_append(mapped_list, 5);
+    return v + 1000;
+}
+
+void test_list_parallel()
+{
+    printf_yellow("  Testing parallel list algorithms ---> ");
+    const size_t count = 100000;
+    static uint16_t values[100000];
+    static size_t counts[LIST_VALUES];
+    uint64_t sum = 0, squares = 0;
+    size_t evens = 0;
+    srand(7);
+    for (size_t i = 0; i < count; i++)
+    {
+        values[i] = rand() % 1000;
+        sum += values[i];
+        squares += (uint64_t)values[i] * values[i];
+        evens += values[i] % 2 == 0;
+    }
+    mem_init(sizeof(Node) * (2 * count + 4 * NODE_CACHE_BATCH));
+    list_parallel_set_threads(4); // Uses the workers even on one CPU
+
+    List list, filtered;
+    my_assert(list_from_array(&list, values, count) == 1);
+    my_assert(list_reduce(&list, 0, NULL, add_u64) == sum);
+    my_assert(list_reduce(&list, 0, square_u16, add_u64) == squares);
+
+    list_histogram(&list, counts);
+    size_t total = 0;
+    for (size_t v = 0; v < LIST_VALUES; v++)
+    {
+        total += counts[v];
+    }
+    my_assert(total == count && counts[values[0]] > 0 && counts[1000] == 0);
+
+    my_assert(list_filter(&list, &filtered, is_even) == 1);
+    my_assert(list_length(&filtered) == evens);
+    Node *node = filtered.head;
+    for (size_t i = 0; i < count; i++) // Order is kept
+    {
+        if (values[i] % 2 != 0)
+            continue;
+        my_assert(node->data == values[i]);
+        node = node->next;
+    }
+    list_destroy(&filtered);
+
+    my_assert(list_map(&list, halve_u16) == 1);
+    my_assert(list.head->data == values[0] / 2 && list.tail->data == values[count - 1] / 2);
+    my_assert(list_sort(&list) == 1);
+    size_t n = 0;
+    for (node = list.head; node->next; node = node->next, n++)
+    {
+        my_assert(node->data <= node->next->data);
+    }
+    my_assert(n + 1 == count && list.tail == node && node->data == 499);
+    list_destroy(&list);
+
+    // Short and indexed lists
+    list_parallel_set_threads(0);
+    list_create_indexed(&list);
+    list_append(&list, 30);
+    list_append(&list, 10);
+    list_append(&list, 20);
+    my_assert(list_reduce(&list, 0, NULL, add_u64) == 60);
+    my_assert(list_sort(&list) == 1);
+    my_assert(list.head->data == 10 && list.tail->data == 30);
+    my_assert(list_find(&list, 10) == list.head && list_find(&list, 30) == list.tail);
+    list_remove(&list, 20);
+    my_assert(list.head->next == list.tail);
+
+    // The callback may use the list; a change makes the map start over.
+    mapped_list = &list;
+    appends_left = 1;
+    my_assert(list_map(&list, grow_and_shift) == 1);
+    my_assert(list_length(&list) == 3 && list.head->data == 1010 && list.tail->data == 1005);
+    my_assert(list_find(&list, 1005) == list.tail && list_find(&list, 5) == NULL);
+    // One that changes it on every attempt makes the map give up.
+    appends_left = 1000;
+    my_assert(list_map(&list, grow_and_shift) == 0);
+    my_assert(list.head->data == 1010 && list.tail->data == 5 && list_length(&list) > 3);
+    list_destroy(&list);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* RCU list *********
+
+void test_rlist_basic()
+{
+    printf_yellow("  Testing RCU list operations ---> ");
+    RList list;
+    mem_init(sizeof(RNode) * 4);
+    rlist_init(&list);
+    rlist_insert(&list, 20);
+    rlist_insert(&list, 30);
+    rlist_push_front(&list, 10);
+    my_assert(rlist_count_nodes(&list) == 3);
+    my_assert(rlist_contains(&list, 30));
+
+    rcu_read_lock();
+    RNode *found = rlist_search(&list, 20);
+    my_assert(found && found->data == 20 && found->next->data == 30);
+    rcu_read_unlock();
+
+    my_assert(rlist_delete(&list, 30));
+    my_assert(!rlist_delete(&list, 30));
+    rlist_insert(&list, 40); // Tail moved back to 20
+    my_assert(list.head->next->next->data == 40);
+    my_assert(rlist_delete(&list, 10));
+    my_assert(list.head->data == 20);
+
+    rlist_cleanup(&list);
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0); // Retired nodes were released
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+#define RCU_KEYS 64
+#define RCU_ROUNDS 2000
+
+static int rcu_stop;
+
+void *rcu_reader(void *arg)
+{
+    RList *list = arg;
+    while (!__atomic_load_n(&rcu_stop, __ATOMIC_ACQUIRE))
+    {
+        // Even keys are never removed, so readers must always see them.
+        for (int key = 0; key < RCU_KEYS; key += 2)
+        {
+            my_assert(rlist_contains(list, key));
+        }
+        rcu_read_lock();
+        RNode *node = __atomic_load_n(&list->head, __ATOMIC_ACQUIRE);
+        for (; node; node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))
+        {
+            my_assert(node->data < RCU_KEYS);
+        }
+        rcu_read_unlock();
+    }
+    return NULL;
+}
+
+void test_rlist_concurrent_readers()
+{
+    printf_yellow("  Testing RCU list with concurrent readers ---> ");
+    RList list;
+    pthread_t readers[CONCURRENT_THREADS];
+    mem_init(sizeof(RNode) * RCU_KEYS * 4);
+    rlist_init(&list);
+    for (int key = 0; key < RCU_KEYS; key++)
+    {
+        rlist_insert(&list, key);
+    }
+
+    rcu_stop = 0;
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        pthread_create(&readers[t], NULL, rcu_reader, &list);
+    }
+    for (int round = 0; round < RCU_ROUNDS; round++)
+    {
+        int key = 1 + 2 * (rand() % (RCU_KEYS / 2));
+        if (rlist_delete(&list, key))
+        {
+            if (round % 2)
+                rlist_insert(&list, key);
+            else
+                rlist_push_front(&list, key);
+        }
+    }
+    __atomic_store_n(&rcu_stop, 1, __ATOMIC_RELEASE);
+    for (int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+        pthread_join(readers[t], NULL);
+    }
+
+    my_assert(rlist_count_nodes(&list) == RCU_KEYS);
+    for (int key = 0; key < RCU_KEYS; key++)
+    {
+        my_assert(rlist_contains(&list, key));
+    }
+
+    rlist_cleanup(&list);
+    MemStats stats;
+    mem_get_stats(&stats);
+    my_assert(stats.used_blocks == 0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
 // Main function to run all tests
 int main(int argc, char *argv[])
 {
@@ -513,6 +1779,40 @@ int main(int argc, char *argv[])
         printf(" 12. test_list_delete_loop - Test multiple detelions\n");
         printf(" 13. test_list_search_loop - Test multiple search\n");
         printf(" 14. test_list_edge_cases - Test edge cases\n");
+
+        printf("\nList Handle:\n");
+        printf(" 15. test_list_handle_append - Test O(1) append and count on a list handle\n");
+        printf(" 16. test_list_handle_tail_tracking - Test tail and count upkeep on a list handle\n");
+        printf(" 17. test_list_insert_after_tail - Test list_insert after extending the tail\n");
+
+        printf("\nUnrolled List:\n");
+        printf(" 18. test_ulist_insert_and_split - Test unrolled list inserts and node splits\n");
+        printf(" 19. test_ulist_delete - Test unrolled list deletes and node merges\n");
+        printf(" 20. test_ulist_display - Test unrolled list display and display range\n");
+        printf(" 21. test_simd_kernels - Test SIMD find/count kernels against the scalar result\n");
+        printf(" 22. test_ulist_count_and_delete_all - Test unrolled list count and delete all\n");
+
+        printf("\nValue Index:\n");
+        printf(" 23. test_list_index_matches_plain - Test an indexed list against a plain list\n");
+        printf(" 24. test_list_index_duplicates - Test indexed find/remove with duplicate values\n");
+
+        printf("\nConcurrency:\n");
+        printf(" 25. test_list_per_list_locks - Test concurrent appends on separate lists\n");
+        printf(" 26. test_clist_concurrent - Test the hand-over-hand list from several threads\n");
+        printf(" 27. test_rlist_basic - Test RCU list operations and deferred frees\n");
+        printf(" 28. test_rlist_concurrent_readers - Test lock-free RCU readers against a writer\n");
+        printf(" 29. test_list_node_cache - Test per-list spare node reuse and release\n");
+        printf(" 30. test_list_format_output - Test buffered formatting to buffers, streams and descriptors\n");
+        printf(" 31. test_dlist_positional - Test O(1) insert-before and node deletion\n");
+        printf(" 32. test_dlist_print_range - Test doubly linked list range display\n");
+        printf(" 33. test_slist_ordered - Test sorted skip list against reference counts\n");
+        printf(" 34. test_slist_print_range - Test sorted list display by value range\n");
+        printf(" 35. test_list_array_roundtrip - Test bulk import from and export to arrays\n");
+        printf(" 36. test_list_compact - Test relocating nodes into list order\n");
+        printf(" 37. test_olist_offsets - Test the list with pool-relative 32-bit links\n");
+        printf(" 38. test_olist_persistent - Test restoring an offset list from a pool file\n");
+        printf(" 39. test_list_snapshot - Test saving and loading binary list snapshots\n");
+        printf(" 40. test_list_parallel - Test parallel reduce, histogram, filter, map and sort\n");
         printf(" 0. Run all tests\n");
 	printf(" 100. Run all tests; -test_list_display() \n");
         return 1;
@@ -540,6 +1840,40 @@ int main(int argc, char *argv[])
         test_list_delete_loop(1000);
         test_list_search_loop(1000);
         test_list_edge_cases();
+
+        printf("\nTesting List Handle:\n");
+        test_list_handle_append();
+        test_list_handle_tail_tracking();
+        test_list_insert_after_tail();
+
+        printf("\nTesting Unrolled List:\n");
+        test_ulist_insert_and_split();
+        test_ulist_delete();
+        test_ulist_display();
+        test_simd_kernels();
+        test_ulist_count_and_delete_all();
+
+        printf("\nTesting Value Index:\n");
+        test_list_index_matches_plain();
+        test_list_index_duplicates();
+
+        printf("\nTesting Concurrency:\n");
+        test_list_per_list_locks();
+        test_clist_concurrent();
+        test_rlist_basic();
+        test_rlist_concurrent_readers();
+        test_list_node_cache();
+        test_list_format_output();
+        test_dlist_positional();
+        test_dlist_print_range();
+        test_slist_ordered();
+        test_slist_print_range();
+        test_list_array_roundtrip();
+        test_list_compact();
+        test_olist_offsets();
+        test_olist_persistent();
+        test_list_snapshot();
+        test_list_parallel();
         break;
     case 0:
         printf("Testing Basic Operations:\n");
@@ -559,6 +1893,40 @@ int main(int argc, char *argv[])
         test_list_delete_loop(1000);
         test_list_search_loop(1000);
         test_list_edge_cases();
+
+        printf("\nTesting List Handle:\n");
+        test_list_handle_append();
+        test_list_handle_tail_tracking();
+        test_list_insert_after_tail();
+
+        printf("\nTesting Unrolled List:\n");
+        test_ulist_insert_and_split();
+        test_ulist_delete();
+        test_ulist_display();
+        test_simd_kernels();
+        test_ulist_count_and_delete_all();
+
+        printf("\nTesting Value Index:\n");
+        test_list_index_matches_plain();
+        test_list_index_duplicates();
+
+        printf("\nTesting Concurrency:\n");
+        test_list_per_list_locks();
+        test_clist_concurrent();
+        test_rlist_basic();
+        test_rlist_concurrent_readers();
+        test_list_node_cache();
+        test_list_format_output();
+        test_dlist_positional();
+        test_dlist_print_range();
+        test_slist_ordered();
+        test_slist_print_range();
+        test_list_array_roundtrip();
+        test_list_compact();
+        test_olist_offsets();
+        test_olist_persistent();
+        test_list_snapshot();
+        test_list_parallel();
         break;
     case 1:
         test_list_init();
@@ -603,6 +1971,84 @@ int main(int argc, char *argv[])
     case 14:
         test_list_edge_cases();
         break;
+    case 15:
+        test_list_handle_append();
+        break;
+    case 16:
+        test_list_handle_tail_tracking();
+        break;
+    case 17:
+        test_list_insert_after_tail();
+        break;
+    case 18:
+        test_ulist_insert_and_split();
+        break;
+    case 19:
+        test_ulist_delete();
+        break;
+    case 20:
+        test_ulist_display();
+        break;
+    case 21:
+        test_simd_kernels();
+        break;
+    case 22:
+        test_ulist_count_and_delete_all();
+        break;
+    case 23:
+        test_list_index_matches_plain();
+        break;
+    case 24:
+        test_list_index_duplicates();
+        break;
+    case 25:
+        test_list_per_list_locks();
+        break;
+    case 26:
+        test_clist_concurrent();
+        break;
+    case 27:
+        test_rlist_basic();
+        break;
+    case 28:
+        test_rlist_concurrent_readers();
+        break;
+    case 29:
+        test_list_node_cache();
+        break;
+    case 30:
+        test_list_format_output();
+        break;
+    case 31:
+        test_dlist_positional();
+        break;
+    case 32:
+        test_dlist_print_range();
+        break;
+    case 33:
+        test_slist_ordered();
+        break;
+    case 34:
+        test_slist_print_range();
+        break;
+    case 35:
+        test_list_array_roundtrip();
+        break;
+    case 36:
+        test_list_compact();
+        break;
+    case 37:
+        test_olist_offsets();
+        break;
+    case 38:
+        test_olist_persistent();
+        break;
+    case 39:
+        test_list_snapshot();
+        break;
+    case 40:
+        test_list_parallel();
+        break;
 
     default:
         printf("Invalid test function\n");
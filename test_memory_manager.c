@@ -1,4 +1,5 @@
 #include "memory_manager.h"
+#include "executor.h"
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
@@ -7,6 +8,9 @@
 #include <dlfcn.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <pthread.h>
 #include "common_defs.h"
 
 #include "gitdata.h"
@@ -101,6 +105,720 @@ void test_resize()
     printf_green("[PASS].\n");
 }
 
+void test_resize_preserves_data()
+{
+    printf_yellow("  Testing mem_resize keeps contents ---> ");
+    mem_init(1024);
+    char *block1 = mem_alloc(100);
+    char *block2 = mem_alloc(100);
+    my_assert(block1 != NULL && block2 != NULL);
+    memset(block1, 'a', 100);
+    memset(block2, 'b', 100);
+
+    // block2 is followed by free space and grows in place.
+    char *grown = mem_resize(block2, 150);
+    my_assert(grown == block2);
+    for (int i = 0; i < 100; i++)
+        my_assert(grown[i] == 'b');
+
+    // block1 is boxed in by block2, so it has to move.
+    char *moved = mem_resize(block1, 300);
+    my_assert(moved != NULL && moved != block1);
+    for (int i = 0; i < 100; i++)
+        my_assert(moved[i] == 'a');
+
+    mem_free(moved);
+    mem_free(grown);
+    void *whole = mem_alloc(1024); // Everything coalesced back
+    my_assert(whole != NULL);
+    mem_free(whole);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_alloc_near_and_run()
+{
+    printf_yellow("  Testing placement hints and contiguous runs ---> ");
+    mem_init(1024);
+    char *a = mem_alloc(16);
+    char *b = mem_alloc(16);
+    char *c = mem_alloc(16);
+    mem_free(b);
+
+    // The hole after a is reused, and c's free neighbour is taken next.
+    char *near_a = mem_alloc_near(a, 8);
+    my_assert(near_a == a + 16);
+    char *near_c = mem_alloc_near(c, 16);
+    my_assert(near_c == c + 16);
+    // Too large for the space after a: first fit instead.
+    char *far = mem_alloc_near(a, 64);
+    my_assert(far != NULL && far != a + 24);
+
+    void *run[64];
+    my_assert(mem_alloc_run(NULL, 16, run, 8) == 8);
+    for (int i = 1; i < 8; i++)
+        my_assert((char *)run[i] == (char *)run[i - 1] + 16);
+    // Only what the largest free extent (the last 768 bytes) can hold is
+    // handed out; the 8-byte hole after near_a is all that remains.
+    size_t got = mem_alloc_run(NULL, 16, run + 8, 64);
+    my_assert(got == 48);
+    my_assert(mem_alloc(16) == NULL);
+
+    mem_free_batch(run, 8 + got);
+    mem_free(a);
+    mem_free(c);
+    mem_free(near_a);
+    mem_free(near_c);
+    mem_free(far);
+    void *whole = mem_alloc(1024);
+    my_assert(whole != NULL);
+    mem_free(whole);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void test_file_pool()
+{
+    printf_yellow("  Testing file-backed pool across reopen ---> ");
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_pool_%d.bin", (int)getpid());
+    unlink(path);
+
+    my_assert(mem_init_file(path, 4096) == 0);
+    char *kept = mem_alloc(100);
+    char *dropped = mem_alloc(200);
+    char *other = mem_alloc(300);
+    my_assert(kept && dropped && other);
+    strcpy(kept, "survives a restart");
+    strcpy(other, "so does this");
+    mem_free(dropped);
+    mem_set_root(mem_offset(kept));
+    MemStats before;
+    mem_get_stats(&before);
+    mem_deinit();
+
+    my_assert(mem_init_file(path, 0) == 1);
+    MemStats after;
+    mem_get_stats(&after);
+    my_assert(after.pool_size == 4096 && after.used_blocks == before.used_blocks);
+    my_assert(after.free_blocks == before.free_blocks);
+    kept = mem_at(mem_get_root());
+    my_assert(kept && strcmp(kept, "survives a restart") == 0);
+    other = kept + 300; // Blocks keep their offsets
+    my_assert(strcmp(other, "so does this") == 0);
+    mem_free(other); // The allocated blocks are known again
+    mem_free(kept);
+    void *whole = mem_alloc(4096);
+    my_assert(whole != NULL);
+    mem_deinit();
+
+    // A process that exits without mem_deinit leaves the file unclean.
+    pid_t child = fork();
+    if (child == 0)
+    {
+        mem_init_file(path, 0);
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    my_assert(mem_init_file(path, 0) == -1);
+
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+#define EXECUTOR_PRODUCERS 8
+#define EXECUTOR_TASKS 20000
+
+typedef struct ExecutorTest
+{
+  Executor *executor;
+  ExecutorGroup group;
+  size_t done;
+} ExecutorTest;
+
+static ExecutorGroup nested_group = EXECUTOR_GROUP_INIT;
+static size_t nested_done;
+
+static void nested_task(void *arg)
+{
+  __atomic_add_fetch((size_t *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void counted_task(void *arg)
+{
+  ExecutorTest *test = arg;
+  size_t n = __atomic_add_fetch(&test->done, 1, __ATOMIC_RELAXED);
+  if (n % 500 == 0)
+  {
+    // Submitting and waiting from inside a task
+    ExecutorGroup inner = EXECUTOR_GROUP_INIT;
+    size_t inner_done = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      executor_submit(test->executor, &inner, nested_task, &inner_done);
+    }
+    executor_submit(test->executor, &nested_group, nested_task, &nested_done);
+    executor_wait(test->executor, &inner);
+    my_assert(inner_done == 4);
+  }
+}
+
+static void *executor_producer(void *arg)
+{
+  ExecutorTest *test = arg;
+  for (int i = 0; i < EXECUTOR_TASKS; i++)
+  {
+    executor_submit(test->executor, &test->group, counted_task, test);
+  }
+  executor_wait(test->executor, &test->group);
+  my_assert(test->done == EXECUTOR_TASKS);
+  return NULL;
+}
+
+static int executor_gate;
+
+static void gated_task(void *arg)
+{
+  while (!__atomic_load_n(&executor_gate, __ATOMIC_ACQUIRE))
+    usleep(100);
+  __atomic_add_fetch((size_t *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void thread_task(void *arg)
+{
+  *(pthread_t *)arg = pthread_self();
+}
+
+void test_executor_contention()
+{
+  printf_yellow("  Testing executor under contention ---> ");
+  Executor *executor = executor_create(4, 256);
+  my_assert(executor != NULL && executor_workers(executor) == 4);
+
+  pthread_t producers[EXECUTOR_PRODUCERS];
+  ExecutorTest tests[EXECUTOR_PRODUCERS];
+  for (int i = 0; i < EXECUTOR_PRODUCERS; i++)
+  {
+    tests[i] = (ExecutorTest){executor, EXECUTOR_GROUP_INIT, 0};
+    pthread_create(&producers[i], NULL, executor_producer, &tests[i]);
+  }
+  for (int i = 0; i < EXECUTOR_PRODUCERS; i++)
+  {
+    pthread_join(producers[i], NULL);
+  }
+  executor_wait(executor, &nested_group);
+  my_assert(nested_done == EXECUTOR_PRODUCERS * EXECUTOR_TASKS / 500);
+  executor_destroy(executor);
+
+  // A full executor refuses try_submit and runs submit on the caller.
+  executor = executor_create(1, 64);
+  ExecutorGroup group = EXECUTOR_GROUP_INIT;
+  size_t ran = 0;
+  int accepted = 0;
+  __atomic_store_n(&executor_gate, 0, __ATOMIC_RELEASE);
+  while (executor_try_submit(executor, &group, gated_task, &ran) == 0)
+  {
+    accepted++;
+  }
+  my_assert(accepted >= 64 && accepted <= 65); // The worker may hold one
+  pthread_t runner;
+  executor_submit(executor, NULL, thread_task, &runner);
+  my_assert(pthread_equal(runner, pthread_self()));
+  __atomic_store_n(&executor_gate, 1, __ATOMIC_RELEASE);
+  executor_wait(executor, &group);
+  my_assert(ran == (size_t)accepted);
+  executor_destroy(executor);
+  printf_green("[PASS].\n");
+}
+
+void test_page_release()
+{
+  printf_yellow("  Testing background page release ---> ");
+  size_t size = 8 << 20;
+  mem_init(size);
+  char *block = mem_alloc(size / 2);
+  my_assert(block != NULL);
+  memset(block, 1, size / 2);
+
+  mem_set_release_threshold(1 << 20);
+  mem_free(block);
+  MemStats stats;
+  for (int i = 0; i < 2000; i++) // Released by a task on the shared executor
+  {
+    mem_get_stats(&stats);
+    if (stats.released_bytes > 0)
+      break;
+    usleep(1000);
+  }
+  my_assert(stats.released_bytes >= size / 2 - 2 * (size_t)sysconf(_SC_PAGESIZE));
+  my_assert(mem_release_free_pages() >= size - 2 * (size_t)sysconf(_SC_PAGESIZE));
+
+  // The pool is still fully usable.
+  block = mem_alloc(size);
+  my_assert(block != NULL);
+  memset(block, 2, size);
+  mem_free(block);
+  mem_set_release_threshold(0);
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+#define MAINT_LIVE 512
+
+void test_background_maintenance()
+{
+  printf_yellow("  Testing background maintenance ---> ");
+  size_t pool = 1 << 20;
+  mem_init(pool);
+  my_assert(mem_start_maintenance(200) == 0);
+
+  // Fragment the pool with 64-byte holes.
+  char *blocks[1000];
+  for (int i = 0; i < 1000; i++)
+  {
+    blocks[i] = mem_alloc(64);
+    my_assert(blocks[i] != NULL);
+  }
+  for (int i = 0; i < 1000; i += 2)
+  {
+    mem_free(blocks[i]);
+  }
+  usleep(5000); // A few ticks
+  char *big = mem_alloc(4096);
+  my_assert(big != NULL && big >= blocks[999] + 64);
+  memset(big, 7, 4096);
+  for (int i = 0; i < 64; i += 2)
+  {
+    blocks[i] = mem_alloc(64); // Filed holes are used first
+    my_assert(blocks[i] != NULL && blocks[i] < blocks[999]);
+  }
+
+  // Random churn with every live block's contents checked.
+  char *live[MAINT_LIVE] = {0};
+  size_t sizes[MAINT_LIVE] = {0};
+  srand(11);
+  for (int op = 0; op < 50000; op++)
+  {
+    int slot = rand() % MAINT_LIVE;
+    if (live[slot])
+    {
+      for (size_t k = 0; k < sizes[slot]; k++)
+        my_assert(live[slot][k] == (char)slot);
+      mem_free(live[slot]);
+      live[slot] = NULL;
+    }
+    else
+    {
+      sizes[slot] = rand() % 8 == 0 ? 1 + rand() % 4000 : 1 + rand() % 200;
+      live[slot] = mem_alloc(sizes[slot]);
+      if (live[slot])
+        memset(live[slot], (char)slot, sizes[slot]);
+    }
+  }
+  for (int i = 0; i < MAINT_LIVE; i++)
+  {
+    mem_free(live[i]);
+  }
+  for (int i = 0; i < 1000; i++)
+  {
+    if (i >= 64 && i % 2 == 0)
+      continue; // Already free
+    mem_free(blocks[i]);
+  }
+  mem_free(big);
+
+  MemStats stats;
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == 0 && stats.free_blocks == 1 && stats.largest_free == pool);
+
+  // The thread outlives a pool.
+  mem_deinit();
+  mem_init(pool);
+  usleep(1000);
+  my_assert(mem_alloc(pool) != NULL);
+  mem_stop_maintenance();
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+#define REMOTE_BLOCKS 1000
+
+static void *remote_free_all(void *arg)
+{
+  void **blocks = arg;
+  for (int i = 0; i < REMOTE_BLOCKS / 2; i++)
+  {
+    mem_free_remote(blocks[i]);
+  }
+  mem_flush_remote();
+  return NULL;
+}
+
+static void *remote_free_and_exit(void *arg)
+{
+  void **blocks = arg;
+  for (int i = REMOTE_BLOCKS / 2; i < REMOTE_BLOCKS; i++)
+  {
+    mem_free_remote(blocks[i]);
+  }
+  return NULL; // The partial batch is handed over at thread exit
+}
+
+void test_remote_free()
+{
+  printf_yellow("  Testing cross-thread remote frees ---> ");
+  void *blocks[REMOTE_BLOCKS];
+  MemStats stats;
+  mem_init(REMOTE_BLOCKS * 32 + 64);
+  for (int i = 0; i < REMOTE_BLOCKS; i++)
+  {
+    blocks[i] = mem_alloc(32);
+    my_assert(blocks[i] != NULL);
+  }
+
+  pthread_t first, second;
+  pthread_create(&first, NULL, remote_free_all, blocks);
+  pthread_create(&second, NULL, remote_free_and_exit, blocks);
+  pthread_join(first, NULL);
+  pthread_join(second, NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == REMOTE_BLOCKS); // Queued, not yet applied
+
+  void *block = mem_alloc(REMOTE_BLOCKS * 32); // Applies them first
+  my_assert(block != NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == 1 && stats.free_blocks == 1);
+  mem_free(block);
+
+  // A batch left over from an earlier pool is not applied to the next one.
+  block = mem_alloc(32);
+  mem_free_remote(block);
+  mem_deinit();
+  mem_init(REMOTE_BLOCKS * 32 + 64);
+  void *reused = mem_alloc(32); // Usually at the stale block's address
+  my_assert(reused != NULL);
+  mem_free_remote(mem_alloc(32));
+  mem_flush_remote();
+  my_assert(mem_alloc(16) != NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == 2); // reused and the 16-byte block
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+static int lock_held = 0;
+
+static void *hold_lock(void *arg)
+{
+  (void)arg;
+  mem_lock();
+  __atomic_store_n(&lock_held, 1, __ATOMIC_SEQ_CST);
+  usleep(20000);
+  mem_unlock();
+  return NULL;
+}
+
+void test_lock_stats()
+{
+  printf_yellow("  Testing allocator lock counters ---> ");
+  MemStats stats;
+  mem_init(4096);
+  for (int i = 0; i < 100; i++)
+  {
+    mem_free(mem_alloc(32));
+  }
+  mem_get_stats(&stats);
+  my_assert(stats.lock.acquisitions >= 200);
+  my_assert(stats.lock.contended == 0 && stats.lock.wait_ns == 0);
+
+  // An allocation that finds the lock held waits for it and is counted.
+  pthread_t holder;
+  __atomic_store_n(&lock_held, 0, __ATOMIC_SEQ_CST);
+  pthread_create(&holder, NULL, hold_lock, NULL);
+  while (!__atomic_load_n(&lock_held, __ATOMIC_SEQ_CST))
+    usleep(100);
+  void *block = mem_alloc(32);
+  pthread_join(holder, NULL);
+  my_assert(block != NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.lock.contended == 1);
+  my_assert(stats.lock.wait_ns > 1000000); // Most of the 20 ms hold
+  mem_deinit();
+
+  mem_init(4096);
+  mem_get_stats(&stats);
+  my_assert(stats.lock.acquisitions < 10 && stats.lock.contended == 0 && stats.lock.wait_ns == 0);
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+#define SYNC_THREADS 4
+#define SYNC_ROUNDS 100000
+
+typedef struct SyncShared
+{
+  SyncLock lock;
+  long counter;
+} SyncShared;
+
+static void *sync_increment(void *arg)
+{
+  SyncShared *shared = arg;
+  for (int i = 0; i < SYNC_ROUNDS; i++)
+  {
+    sync_lock(&shared->lock);
+    shared->counter++;
+    sync_unlock(&shared->lock);
+  }
+  return NULL;
+}
+
+void test_sync_lock()
+{
+  printf_yellow("  Testing the %s lock ---> ", sync_lock_kind());
+  SyncShared shared;
+  sync_lock_init(&shared.lock);
+  shared.counter = 0;
+
+  my_assert(sync_trylock(&shared.lock) == 1);
+  my_assert(sync_trylock(&shared.lock) == 0); // Already held
+  sync_unlock(&shared.lock);
+
+  pthread_t threads[SYNC_THREADS];
+  for (int t = 0; t < SYNC_THREADS; t++)
+  {
+    pthread_create(&threads[t], NULL, sync_increment, &shared);
+  }
+  for (int t = 0; t < SYNC_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+  }
+  my_assert(shared.counter == (long)SYNC_THREADS * SYNC_ROUNDS);
+  my_assert(shared.lock.stats.acquisitions == (size_t)SYNC_THREADS * SYNC_ROUNDS + 1);
+  my_assert(shared.lock.stats.contended <= shared.lock.stats.acquisitions);
+  my_assert(shared.lock.stats.spun <= shared.lock.stats.contended);
+  sync_lock_destroy(&shared.lock);
+  printf_green("[PASS].\n");
+}
+
+typedef struct TypedPair
+{
+  void *first;
+  uint64_t second;
+  uint16_t third;
+} TypedPair; // 24 bytes, so in the 32-byte class
+
+static void *typed_alloc_and_exit(void *arg)
+{
+  (void)arg;
+  TypedPair *pair = MEM_ALLOC_TYPED(TypedPair);
+  my_assert(pair != NULL);
+  MEM_FREE_TYPED(TypedPair, pair);
+  return NULL; // The thread's cached blocks go back as it exits
+}
+
+void test_typed_alloc()
+{
+  printf_yellow("  Testing size-class typed allocation ---> ");
+  my_assert(MEM_TYPE_CLASS(char[16]) == 0 && MEM_TYPE_CLASS(char[17]) == 1);
+  my_assert(MEM_TYPE_CLASS(TypedPair) == 1 && MEM_TYPE_CLASS(char[MEM_CLASS_MAX]) == MEM_CLASSES - 1);
+
+  MemStats stats;
+  TypedPair *pairs[100];
+  mem_init(4096);
+  pairs[0] = MEM_ALLOC_TYPED(TypedPair);
+  my_assert(pairs[0] != NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == MEM_CLASS_BATCH && stats.used_bytes == MEM_CLASS_BATCH * 32); // One refill
+  for (int i = 1; i < 100; i++)
+  {
+    pairs[i] = MEM_ALLOC_TYPED(TypedPair);
+    my_assert(pairs[i] != NULL && pairs[i] != pairs[i - 1]);
+    pairs[i]->third = i;
+  }
+  for (int i = 1; i < 100; i++)
+  {
+    my_assert(pairs[i]->third == i);
+  }
+
+  // Freed blocks are reused first; the stack gives half back once full.
+  MEM_FREE_TYPED(TypedPair, pairs[99]);
+  my_assert(MEM_ALLOC_TYPED(TypedPair) == pairs[99]);
+  for (int i = 1; i < 100; i++)
+  {
+    MEM_FREE_TYPED(TypedPair, pairs[i]);
+  }
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks <= 1 + MEM_CLASS_CACHE);
+  mem_free(pairs[0]); // Class blocks are ordinary blocks too
+
+  pthread_t thread;
+  mem_get_stats(&stats);
+  size_t before = stats.used_blocks;
+  pthread_create(&thread, NULL, typed_alloc_and_exit, NULL);
+  pthread_join(thread, NULL);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == before);
+
+  // The cache of the old pool is dropped, not handed out.
+  mem_deinit();
+  mem_init(4096);
+  TypedPair *fresh = MEM_ALLOC_TYPED(TypedPair);
+  my_assert(fresh != NULL && mem_offset(fresh) != MEM_NO_OFFSET);
+  mem_get_stats(&stats);
+  my_assert(stats.used_blocks == MEM_CLASS_BATCH);
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+static int all_zero(const unsigned char *bytes, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    if (bytes[i] != 0)
+      return 0;
+  }
+  return 1;
+}
+
+void test_calloc()
+{
+  printf_yellow("  Testing zeroed allocation ---> ");
+  my_assert(mem_calloc(SIZE_MAX / 2, 4) == NULL); // count * size overflows
+
+  // Reused space is cleared, fresh space is zero already.
+  mem_init(64 * 1024);
+  unsigned char *block = mem_calloc(100, 4);
+  my_assert(block != NULL && all_zero(block, 400));
+  memset(block, 0xff, 400);
+  mem_free(block);
+  unsigned char *again = mem_calloc(4, 100);
+  my_assert(again == block && all_zero(again, 400));
+  unsigned char *fresh = mem_calloc(1, 20000); // Spans pages never handed out
+  my_assert(fresh != NULL && all_zero(fresh, 20000));
+  memset(fresh, 0xee, 20000);
+  mem_free(again);
+  mem_free(fresh);
+  unsigned char *whole = mem_calloc(64, 1024); // The whole pool, part of it dirty
+  my_assert(whole != NULL && all_zero(whole, 64 * 1024));
+  mem_free(whole);
+  mem_deinit();
+
+  // Pages given back with mem_release_free_pages read as zero.
+  mem_init(4 << 20);
+  block = mem_alloc(1 << 20);
+  memset(block, 0xab, 1 << 20);
+  mem_free(block);
+  my_assert(mem_release_free_pages() > 0);
+  block = mem_calloc(1 << 10, 1 << 10);
+  my_assert(block != NULL && all_zero(block, 1 << 20));
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+void test_large_alloc()
+{
+  printf_yellow("  Testing large blocks outside the pool ---> ");
+  MemStats stats;
+  mem_init(16 * 1024);
+  mem_set_large_threshold(8192);
+  unsigned char *small = mem_alloc(100);
+  my_assert(small != NULL && mem_offset(small) != MEM_NO_OFFSET);
+
+  unsigned char *large = mem_alloc(64 * 1024); // Bigger than the pool itself
+  my_assert(large != NULL && mem_offset(large) == MEM_NO_OFFSET);
+  memset(large, 0x3c, 64 * 1024);
+  mem_get_stats(&stats);
+  my_assert(stats.large_blocks == 1 && stats.large_bytes >= 64 * 1024);
+  my_assert(stats.used_blocks == 1 && stats.used_bytes == 100);
+
+  // Growth keeps the contents without going through the pool.
+  large = mem_resize(large, 4 << 20);
+  my_assert(large != NULL && large[0] == 0x3c && large[64 * 1024 - 1] == 0x3c);
+  large[(4 << 20) - 1] = 1;
+  mem_get_stats(&stats);
+  my_assert(stats.large_blocks == 1 && stats.large_bytes >= (4 << 20));
+
+  // A pool block that grows past the threshold moves out of the pool.
+  memset(small, 0x7e, 100);
+  unsigned char *moved = mem_resize(small, 10000);
+  my_assert(moved != NULL && mem_offset(moved) == MEM_NO_OFFSET && moved[99] == 0x7e);
+  unsigned char *zeroed = mem_calloc(4, 4096);
+  my_assert(zeroed != NULL && mem_offset(zeroed) == MEM_NO_OFFSET && all_zero(zeroed, 4 * 4096));
+  mem_get_stats(&stats);
+  my_assert(stats.large_blocks == 3 && stats.used_blocks == 0);
+
+  mem_free(large);
+  mem_free(moved);
+  mem_get_stats(&stats);
+  my_assert(stats.large_blocks == 1);
+  mem_deinit(); // Unmaps zeroed
+  mem_set_large_threshold(0);
+
+  mem_init(1024);
+  my_assert(mem_alloc(2048) == NULL); // Back to pool-only allocation
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
+void test_numa_pool()
+{
+  printf_yellow("  Testing NUMA pool segments ---> ");
+  MemStats stats;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+  // One segment per online node; a single-node machine gets one, unbound
+  // or on node 0.
+  int segments = mem_init_numa(16 * page, 0);
+  my_assert(segments >= 1 && segments <= MEM_MAX_NODES);
+  mem_get_stats(&stats);
+  my_assert(stats.segments == segments && stats.pool_size == 16 * page);
+  size_t total = 0;
+  for (int i = 0; i < segments; i++)
+  {
+    total += stats.segment[i].size;
+  }
+  my_assert(total == stats.pool_size);
+  void *block = mem_alloc(100);
+  my_assert(block != NULL && mem_offset(block) != MEM_NO_OFFSET);
+  mem_free(block);
+  mem_deinit();
+
+  // Two segments whatever the machine: each fills up on its own, and no
+  // block spans or merges across the boundary.
+  my_assert(mem_init_numa(10 * page + 1, 2) == 2);
+  mem_get_stats(&stats);
+  my_assert(stats.pool_size == 11 * page && stats.free_blocks == 2);
+  size_t first = stats.segment[0].size, second = stats.segment[1].size;
+  my_assert(first == 5 * page && second == 6 * page);
+  my_assert(mem_alloc(first + second) == NULL);
+  unsigned char *a = mem_alloc(first);
+  unsigned char *b = mem_alloc(second);
+  my_assert(a != NULL && b != NULL && all_zero(a, first) && all_zero(b, second));
+  mem_get_stats(&stats);
+  my_assert(stats.segment[0].used_bytes == first && stats.segment[0].free_bytes == 0);
+  my_assert(stats.segment[1].used_bytes == second && stats.segment[1].free_bytes == 0);
+  mem_free(b);
+  b = mem_resize(a, first + page); // Moves instead of growing into segment 1
+  my_assert(b != NULL && b != a && mem_offset(b) == first);
+  mem_free(b);
+  mem_get_stats(&stats);
+  my_assert(stats.free_blocks == 2 && stats.segment[1].free_bytes == second);
+
+  // A run that fits no segment is cut to the largest one, never spanning two.
+  void *run[8];
+  my_assert(mem_alloc_run(NULL, page, run, 8) == 6);
+  my_assert(mem_offset(run[0]) == first && mem_offset(run[5]) == first + 5 * page);
+  mem_free_batch(run, 6);
+  mem_deinit();
+
+  mem_init(1024);
+  mem_get_stats(&stats);
+  my_assert(stats.segments == 1 && stats.segment[0].node == -1 && stats.segment[0].free_bytes == 1024);
+  mem_deinit();
+  printf_green("[PASS].\n");
+}
+
 void test_exceed_single_allocation()
 {
     printf_yellow("  Testing allocation exceeding pool size ---> ");
@@ -447,6 +1165,19 @@ int main(int argc, char *argv[])
         printf(" 19. test_init, but large memory - Initialize memory system\n");
 	printf(" 20. test_looking_for_out_of_bounds, needs LD_PRELOAD=./libmymalloc.so .Needs argument of size.\n\n");
 	printf(" 21. test_mmap, needs LD_PRELOAD=./libmymalloc.so .\n\n");
+        printf(" 22. test_resize_preserves_data - Test that mem_resize keeps contents when moving or growing\n");
+        printf(" 23. test_alloc_near_and_run - Test placement hints and contiguous block runs\n");
+        printf(" 24. test_file_pool - Test reopening a file-backed pool and unclean shutdown detection\n");
+        printf(" 25. test_executor_contention - Test the work-stealing executor with many producers\n");
+        printf(" 26. test_page_release - Test releasing free pool pages in the background\n");
+        printf(" 27. test_background_maintenance - Test allocation with the maintenance thread running\n");
+        printf(" 28. test_remote_free - Test queued frees from other threads\n");
+        printf(" 29. test_lock_stats - Test allocator lock contention counters\n");
+        printf(" 30. test_sync_lock - Test the allocator/list lock under contention\n");
+        printf(" 31. test_typed_alloc - Test the size-class typed allocation fast path\n");
+        printf(" 32. test_calloc - Test zeroed allocation and its overflow check\n");
+        printf(" 33. test_large_alloc - Test large blocks in mappings of their own\n");
+        printf(" 34. test_numa_pool - Test NUMA pool segments and their stats\n");
 	
         printf(" 0. Run all tests (excluding 20)\n");
         return 1;
@@ -463,6 +1194,7 @@ int main(int argc, char *argv[])
         test_init(1024);
         test_alloc_and_free();
         test_resize();
+        test_resize_preserves_data();
 
         printf("\nTesting Stress and Edge Cases:\n");
         test_exceed_single_allocation();
@@ -480,6 +1212,18 @@ int main(int argc, char *argv[])
         test_block_merging();
         test_non_contiguous_allocation_failure();
         test_contiguous_allocation_success();
+        test_alloc_near_and_run();
+        test_file_pool();
+        test_executor_contention();
+        test_page_release();
+        test_background_maintenance();
+        test_remote_free();
+        test_lock_stats();
+        test_sync_lock();
+        test_typed_alloc();
+        test_calloc();
+        test_large_alloc();
+        test_numa_pool();
 
         printf("\nVarious other tests:\n");
         test_zero_alloc_and_free();
@@ -552,6 +1296,45 @@ int main(int argc, char *argv[])
       printf("Test 21.\n");
       test_mmap();
       break;
+    case 22:
+      test_resize_preserves_data();
+      break;
+    case 23:
+      test_alloc_near_and_run();
+      break;
+    case 24:
+      test_file_pool();
+      break;
+    case 25:
+      test_executor_contention();
+      break;
+    case 26:
+      test_page_release();
+      break;
+    case 27:
+      test_background_maintenance();
+      break;
+    case 28:
+      test_remote_free();
+      break;
+    case 29:
+      test_lock_stats();
+      break;
+    case 30:
+      test_sync_lock();
+      break;
+    case 31:
+      test_typed_alloc();
+      break;
+    case 32:
+      test_calloc();
+      break;
+    case 33:
+      test_large_alloc();
+      break;
+    case 34:
+      test_numa_pool();
+      break;
     default:
       printf("Invalid test function\n");
       break;
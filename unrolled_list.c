@@ -0,0 +1,273 @@
+#include "memory_manager.h"
+#include "unrolled_list.h"
+#include "simd_scan.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+static SyncLock ulist_lock = SYNC_LOCK_INIT;
+
+static UNode * unode_new(void) {
+    UNode * node = (UNode *)mem_alloc(sizeof(UNode));
+    if (!node) return NULL;
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+// Puts data at index within node, splitting a full node in two first.
+static int insert_at_unlocked(UList * list, UNode * node, int index, uint16_t data) {
+    if (node->count == UNODE_CAPACITY) {
+        UNode * split = unode_new();
+        if (!split) return 0;
+
+        int half = UNODE_CAPACITY / 2;
+        split->count = node->count - half;
+        memcpy(split->values, node->values + half, split->count * sizeof(uint16_t));
+        node->count = half;
+        split->next = node->next;
+        node->next = split;
+        if (list->tail == node) list->tail = split;
+
+        if (index > half) {
+            node = split;
+            index -= half;
+        }
+    }
+
+    memmove(node->values + index + 1, node->values + index,
+            (node->count - index) * sizeof(uint16_t));
+    node->values[index] = data;
+    node->count++;
+    list->count++;
+    return 1;
+}
+
+static void display_range_unlocked(UList * list, UPos start, UPos end) {
+    UNode * node = start.node ? start.node : list->head;
+    int index = start.node ? start.index : 0;
+
+    printf("[");
+    bool first = true;
+    while (node) {
+        for (; index < node->count; index++) {
+            if (!first) printf(", ");
+            printf("%d", node->values[index]);
+            first = false;
+            if (node == end.node && index == end.index) {
+                printf("]");
+                return;
+            }
+        }
+        node = node->next;
+        index = 0;
+    }
+    printf("]");
+}
+
+void ulist_init(UList * list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+}
+
+void ulist_insert(UList * list, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    // Appending starts a fresh node rather than splitting, so lists built
+    // front to back are fully packed.
+    if (!list->tail || list->tail->count == UNODE_CAPACITY) {
+        UNode * node = unode_new();
+        if (!node) {
+            printf("Failed to allocate new node.\n");
+            sync_unlock(&ulist_lock);
+            return;
+        }
+        if (list->tail) list->tail->next = node;
+        else list->head = node;
+        list->tail = node;
+    }
+
+    list->tail->values[list->tail->count++] = data;
+    list->count++;
+
+    sync_unlock(&ulist_lock);
+}
+
+void ulist_insert_after(UList * list, UPos pos, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    if (!pos.node) {
+        printf("Cannot insert after a NULL node.\n");
+    } else if (!insert_at_unlocked(list, pos.node, pos.index + 1, data)) {
+        printf("Allocation failed.\n");
+    }
+
+    sync_unlock(&ulist_lock);
+}
+
+void ulist_insert_before(UList * list, UPos pos, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    if (!pos.node) {
+        printf("Invalid input.\n");
+    } else if (!insert_at_unlocked(list, pos.node, pos.index, data)) {
+        printf("Allocation failed.\n");
+    }
+
+    sync_unlock(&ulist_lock);
+}
+
+void ulist_delete(UList * list, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    UNode * previous = NULL;
+    UNode * node = list->head;
+    int index = -1;
+
+    while (node) {
+        index = (int)u16_find(node->values, node->count, data);
+        if (index >= 0) break;
+        previous = node;
+        node = node->next;
+    }
+
+    if (!node) {
+        sync_unlock(&ulist_lock);
+        return;
+    }
+
+    memmove(node->values + index, node->values + index + 1,
+            (node->count - index - 1) * sizeof(uint16_t));
+    node->count--;
+    list->count--;
+
+    if (node->count == 0) {
+        if (previous) previous->next = node->next;
+        else list->head = node->next;
+        if (list->tail == node) list->tail = previous;
+        mem_free(node);
+    } else {
+        // Fold into a neighbour when both fit one node, to keep nodes full.
+        if (previous && previous->count + node->count <= UNODE_CAPACITY) {
+            node = previous;
+        }
+        UNode * next = node->next;
+        if (next && node->count + next->count <= UNODE_CAPACITY) {
+            memcpy(node->values + node->count, next->values, next->count * sizeof(uint16_t));
+            node->count += next->count;
+            node->next = next->next;
+            if (list->tail == next) list->tail = node;
+            mem_free(next);
+        }
+    }
+
+    sync_unlock(&ulist_lock);
+}
+
+UPos ulist_search(UList * list, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    UPos pos = {NULL, -1};
+    for (UNode * node = list->head; node; node = node->next) {
+        long index = u16_find(node->values, node->count, data);
+        if (index >= 0) {
+            pos.node = node;
+            pos.index = (int)index;
+            break;
+        }
+    }
+
+    sync_unlock(&ulist_lock);
+    return pos;
+}
+
+size_t ulist_count_value(UList * list, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    size_t count = 0;
+    for (UNode * node = list->head; node; node = node->next) {
+        count += u16_count(node->values, node->count, data);
+    }
+
+    sync_unlock(&ulist_lock);
+    return count;
+}
+
+size_t ulist_delete_all(UList * list, uint16_t data) {
+    sync_lock(&ulist_lock);
+
+    size_t removed = 0;
+    UNode * previous = NULL;
+    UNode * node = list->head;
+    while (node) {
+        UNode * next = node->next;
+        long index = u16_find(node->values, node->count, data);
+
+        if (index >= 0) {
+            int kept = (int)index;
+            for (int i = kept + 1; i < node->count; i++) {
+                if (node->values[i] != data) node->values[kept++] = node->values[i];
+            }
+            removed += node->count - kept;
+            node->count = kept;
+        }
+
+        if (node->count == 0) {
+            if (previous) previous->next = next;
+            else list->head = next;
+            if (list->tail == node) list->tail = previous;
+            mem_free(node);
+        } else if (previous && previous->count + node->count <= UNODE_CAPACITY) {
+            memcpy(previous->values + previous->count, node->values, node->count * sizeof(uint16_t));
+            previous->count += node->count;
+            previous->next = next;
+            if (list->tail == node) list->tail = previous;
+            mem_free(node);
+        } else {
+            previous = node;
+        }
+        node = next;
+    }
+    list->count -= removed;
+
+    sync_unlock(&ulist_lock);
+    return removed;
+}
+
+void ulist_display(UList * list) {
+    sync_lock(&ulist_lock);
+    UPos none = {NULL, -1};
+    display_range_unlocked(list, none, none);
+    printf("\n");
+    sync_unlock(&ulist_lock);
+}
+
+void ulist_display_range(UList * list, UPos start, UPos end) {
+    sync_lock(&ulist_lock);
+    display_range_unlocked(list, start, end);
+    sync_unlock(&ulist_lock);
+}
+
+size_t ulist_count_nodes(UList * list) {
+    sync_lock(&ulist_lock);
+    size_t count = list->count;
+    sync_unlock(&ulist_lock);
+    return count;
+}
+
+void ulist_cleanup(UList * list) {
+    sync_lock(&ulist_lock);
+
+    UNode * node = list->head;
+    while (node) {
+        UNode * next = node->next;
+        mem_free(node);
+        node = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+
+    sync_unlock(&ulist_lock);
+}
@@ -0,0 +1,46 @@
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Values per node, chosen so that a UNode fills one 64-byte cache line.
+#define UNODE_CAPACITY 27
+
+typedef struct UNode {
+    struct UNode * next;
+    uint16_t count;
+    uint16_t values[UNODE_CAPACITY];
+} UNode;
+
+// Unrolled list handle; count is the number of values, not of UNodes. Nodes
+// come from the memory manager pool, which must be initialised (mem_init)
+// before ulist_init is used.
+typedef struct UList {
+    UNode * head;
+    UNode * tail;
+    size_t count;
+} UList;
+
+// Position of a single value. Positions are invalidated by any insert or
+// delete, since values shift within and between nodes.
+typedef struct UPos {
+    UNode * node;
+    int index;
+} UPos;
+
+void ulist_init(UList * list);
+void ulist_insert(UList * list, uint16_t data);
+void ulist_insert_after(UList * list, UPos pos, uint16_t data);
+void ulist_insert_before(UList * list, UPos pos, uint16_t data);
+void ulist_delete(UList * list, uint16_t data);
+UPos ulist_search(UList * list, uint16_t data);
+size_t ulist_count_value(UList * list, uint16_t data);
+// Removes every occurrence of data and returns how many were removed.
+size_t ulist_delete_all(UList * list, uint16_t data);
+void ulist_display(UList * list);
+void ulist_display_range(UList * list, UPos start, UPos end);
+size_t ulist_count_nodes(UList * list);
+void ulist_cleanup(UList * list);
+
+#endif // UNROLLED_LIST_H
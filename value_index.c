@@ -0,0 +1,199 @@
+#include "value_index.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define VALUE_COUNT 65536
+#define INDEX_MIN_CAPACITY 64
+
+// Entries are referred to by their position in the entry array; position 0
+// is never used and stands for none.
+typedef struct IndexEntry {
+    Node * node;
+    Node * prev;
+    uint32_t older;  // Neighbours among the entries for the same value;
+    uint32_t newer;  // older also chains spare positions
+} IndexEntry;
+
+typedef struct IndexBucket {
+    uint32_t oldest;
+    uint32_t newest;
+} IndexBucket;
+
+/*
+ * Each value's entries form a chain from oldest to newest, so the oldest
+ * is at hand and any entry unlinks in O(1). An open addressing table from
+ * node address to entry position finds a node's entry without looking at
+ * the other nodes holding its value, however many there are.
+ */
+struct ValueIndex {
+    IndexBucket buckets[VALUE_COUNT];
+    IndexEntry * entries;
+    uint32_t entry_capacity;
+    uint32_t entry_used;  // Positions handed out so far, 0 included
+    uint32_t spare;       // Most recently freed position
+    uint32_t * slots;     // Entry positions, 0 for an empty slot
+    size_t slot_capacity;
+    size_t count;
+};
+
+static size_t slot_home(ValueIndex * index, const Node * node) {
+    uintptr_t key = (uintptr_t)node;
+    key ^= key >> 33;
+    key *= (uintptr_t)0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key & (index->slot_capacity - 1);
+}
+
+static int slots_grow(ValueIndex * index) {
+    size_t capacity = index->slot_capacity ? index->slot_capacity * 2 : INDEX_MIN_CAPACITY;
+    uint32_t * old = index->slots;
+    size_t old_capacity = index->slot_capacity;
+
+    index->slots = calloc(capacity, sizeof(uint32_t));
+    if (!index->slots) {
+        index->slots = old;
+        return 0;
+    }
+    index->slot_capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old[i]) continue;
+        size_t slot = slot_home(index, index->entries[old[i]].node);
+        while (index->slots[slot]) slot = (slot + 1) & (capacity - 1);
+        index->slots[slot] = old[i];
+    }
+    free(old);
+    return 1;
+}
+
+// Slot holding node's entry, or -1.
+static long slot_find(ValueIndex * index, const Node * node) {
+    if (!index->slots) return -1;
+    size_t slot = slot_home(index, node);
+    while (index->slots[slot]) {
+        if (index->entries[index->slots[slot]].node == node) return (long)slot;
+        slot = (slot + 1) & (index->slot_capacity - 1);
+    }
+    return -1;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones.
+static void slot_remove(ValueIndex * index, size_t slot) {
+    size_t mask = index->slot_capacity - 1;
+    size_t hole = slot;
+    size_t next = (hole + 1) & mask;
+
+    while (index->slots[next]) {
+        size_t home = slot_home(index, index->entries[index->slots[next]].node);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index->slots[hole] = index->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    index->slots[hole] = 0;
+}
+
+static IndexEntry * entry_find(ValueIndex * index, const Node * node) {
+    long slot = slot_find(index, node);
+    return slot < 0 ? NULL : &index->entries[index->slots[slot]];
+}
+
+// Returns a free entry position, or 0 if the array could not grow.
+static uint32_t entry_new(ValueIndex * index) {
+    if (index->spare) {
+        uint32_t position = index->spare;
+        index->spare = index->entries[position].older;
+        return position;
+    }
+    if (index->entry_used >= index->entry_capacity) {
+        if (index->entry_capacity > UINT32_MAX / 2) return 0;
+        uint32_t capacity = index->entry_capacity ? index->entry_capacity * 2 : INDEX_MIN_CAPACITY;
+        IndexEntry * entries = realloc(index->entries, capacity * sizeof(IndexEntry));
+        if (!entries) return 0;
+        index->entries = entries;
+        index->entry_capacity = capacity;
+    }
+    return index->entry_used++;
+}
+
+ValueIndex * value_index_new(void) {
+    ValueIndex * index = calloc(1, sizeof(ValueIndex));
+    if (index) index->entry_used = 1;
+    return index;
+}
+
+void value_index_free(ValueIndex * index) {
+    if (!index) return;
+    free(index->entries);
+    free(index->slots);
+    free(index);
+}
+
+int value_index_add(ValueIndex * index, Node * node, Node * prev) {
+    if ((index->count + 1) * 2 > index->slot_capacity && !slots_grow(index)) return 0;
+    uint32_t position = entry_new(index);
+    if (!position) return 0;
+
+    IndexBucket * bucket = &index->buckets[node->data];
+    IndexEntry * entry = &index->entries[position];
+    entry->node = node;
+    entry->prev = prev;
+    entry->older = bucket->newest;
+    entry->newer = 0;
+    if (bucket->newest) index->entries[bucket->newest].newer = position;
+    else bucket->oldest = position;
+    bucket->newest = position;
+
+    size_t slot = slot_home(index, node);
+    while (index->slots[slot]) slot = (slot + 1) & (index->slot_capacity - 1);
+    index->slots[slot] = position;
+    index->count++;
+    return 1;
+}
+
+void value_index_remove(ValueIndex * index, Node * node) {
+    long slot = slot_find(index, node);
+    if (slot < 0) return;
+    uint32_t position = index->slots[slot];
+    slot_remove(index, (size_t)slot);
+
+    IndexBucket * bucket = &index->buckets[node->data];
+    IndexEntry * entry = &index->entries[position];
+    if (entry->older) index->entries[entry->older].newer = entry->newer;
+    else bucket->oldest = entry->newer;
+    if (entry->newer) index->entries[entry->newer].older = entry->older;
+    else bucket->newest = entry->older;
+
+    entry->node = NULL;
+    entry->older = index->spare;
+    index->spare = position;
+    index->count--;
+}
+
+int value_index_get_prev(ValueIndex * index, Node * node, Node ** prev) {
+    IndexEntry * entry = entry_find(index, node);
+    if (!entry) return 0;
+    *prev = entry->prev;
+    return 1;
+}
+
+int value_index_set_prev(ValueIndex * index, Node * node, Node * prev) {
+    IndexEntry * entry = entry_find(index, node);
+    if (!entry) return 0;
+    entry->prev = prev;
+    return 1;
+}
+
+Node * value_index_first(ValueIndex * index, uint16_t data, Node ** prev) {
+    IndexBucket * bucket = &index->buckets[data];
+    if (!bucket->oldest) return NULL;
+    IndexEntry * entry = &index->entries[bucket->oldest];
+    if (prev) *prev = entry->prev;
+    return entry->node;
+}
+
+size_t value_index_bytes(ValueIndex * index) {
+    return sizeof(ValueIndex) + index->entry_capacity * sizeof(IndexEntry)
+         + index->slot_capacity * sizeof(uint32_t);
+}
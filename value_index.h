@@ -0,0 +1,26 @@
+#ifndef VALUE_INDEX_H
+#define VALUE_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "linked_list.h"
+
+// Side index from value to the nodes holding it, each with its predecessor,
+// so a list can find, unlink and insert before a node without walking.
+// Within a value, entries are kept in the order they were added.
+typedef struct ValueIndex ValueIndex;
+
+ValueIndex * value_index_new(void);
+void value_index_free(ValueIndex * index);
+// Returns 0 if the entry could not be allocated.
+int value_index_add(ValueIndex * index, Node * node, Node * prev);
+void value_index_remove(ValueIndex * index, Node * node);
+// Both return 0 if node is not indexed.
+int value_index_get_prev(ValueIndex * index, Node * node, Node ** prev);
+int value_index_set_prev(ValueIndex * index, Node * node, Node * prev);
+// Oldest indexed node holding data, or NULL; its predecessor goes to *prev.
+Node * value_index_first(ValueIndex * index, uint16_t data, Node ** prev);
+// Heap bytes used by the index.
+size_t value_index_bytes(ValueIndex * index);
+
+#endif // VALUE_INDEX_H